@@ -108,6 +108,12 @@ bool AppDelegate::applicationDidFinishLaunching() {
 void AppDelegate::applicationDidEnterBackground() {
     Director::getInstance()->stopAnimation();
 
+    // ̨ʱ浱ǰԾ֣Ӧñϵͳպ´Լ
+    GameScene* gameScene = dynamic_cast<GameScene*>(Director::getInstance()->getRunningScene());
+    if (gameScene) {
+        gameScene->saveGame();
+    }
+
 #if USE_AUDIO_ENGINE
     AudioEngine::pauseAll();
 #elif USE_SIMPLE_AUDIO_ENGINE
@@ -4,10 +4,12 @@
 
 
 #include "../models/LevelConfig.h"
+#include "LevelPack.h"
+#include "LevelConfigParser.h"
 #include "cocos2d.h"
-#include "json/document.h"
 #include "json/stringbuffer.h"
 #include "json/writer.h"
+#include "json/prettywriter.h"
 
 USING_NS_CC;
 
@@ -22,87 +24,143 @@ public:
     // ָ̬ؿID
     static LevelConfig& loadLevelConfig(int levelId)
     {
-        // ļlevel_1.json
-        std::string filename = StringUtils::format("level_%d.json", levelId);
+        // ȴԤĶƹؿȡȥJSON
+        if (getLevelPack().loadLevelConfig(levelId, LevelConfig::getInstance())) {
+            return LevelConfig::getInstance();
+        }
 
         // ȡļ·
+        std::string fullPath = getLevelFilePath(levelId);
+        if (fullPath.empty()) {
+            return LevelConfig::getInstance();
+        }
+
+        loadLevelConfigFromFile(fullPath, LevelConfig::getInstance());
+        return LevelConfig::getInstance();
+    }
+
+    /**
+     * ȡؿJSONļ·
+     *  FileUtils ·棬̵ֻ߳
+     * @param levelId ؿID
+     * @return ·ļʱΪ
+     */
+    static std::string getLevelFilePath(int levelId)
+    {
+        // ļlevel_1.json
+        std::string filename = StringUtils::format("level_%d.json", levelId);
         std::string fullPath = FileUtils::getInstance()->fullPathForFilename(filename);
         if (fullPath.empty()) {
             CCLOG("LevelConfigLoader: file not found: %s", filename.c_str());
-            return LevelConfig::getInstance();
         }
+        return fullPath;
+    }
+
+    /**
+     * ȡĬϹؿlevels.pack״εʱ
+     * ûйؿʱδ򿪵ʵйؿ˵JSONļ
+     * ״ε̣߳򿪺Ĺؿֻ̲߳ѯ
+     */
+    static LevelPack& getLevelPack()
+    {
+        static LevelPack levelPack;
+        static bool opened = openDefaultLevelPack(levelPack);
+        (void)opened;
+        return levelPack;
+    }
 
+    /**
+     * ָļعؿö
+     * ·ʱ FileUtils ·棬ڹ߳е
+     * FileUtils::getInstance() ߳д
+     * @param fullPath ؿļ·
+     * @param levelConfig սĹؿ
+     * @return Ƿسɹ
+     */
+    static bool loadLevelConfigFromFile(const std::string& fullPath, LevelConfig& levelConfig)
+    {
         // ȡļ
         std::string content = FileUtils::getInstance()->getStringFromFile(fullPath);
         if (content.empty()) {
-            CCLOG("LevelConfigLoader: file is empty: %s", filename.c_str());
-            return LevelConfig::getInstance();
+            CCLOG("LevelConfigLoader: file is empty: %s", fullPath.c_str());
+            return false;
         }
 
-        rapidjson::Document doc;
-        doc.Parse(content.c_str());
-        if (doc.HasParseError()) {
-            CCLOG("LevelConfigLoader: JSON parse error: %s", doc.GetParseError());
-            return LevelConfig::getInstance();
+        // ʽֱдDOMԭظд content
+        std::vector<LevelConfig::CardItem> playFieldCards;
+        std::vector<LevelConfig::CardItem> stackCards;
+        LevelParseError error;
+        if (!LevelConfigParser::parseInsitu(&content[0], playFieldCards, stackCards, &error)) {
+            CCLOG("LevelConfigLoader: JSON parse error at offset %d: %s (%s)",
+                (int)error.offset, error.message.c_str(), fullPath.c_str());
+            return false;
         }
 
-        // LevelConfig
-        LevelConfig& levelConfig = LevelConfig::getInstance();
-
-        // 
-        if (doc.HasMember("Playfield") && doc["Playfield"].IsArray()) {
-            std::vector<LevelConfig::CardItem> playFieldCards;
-            const rapidjson::Value& playfieldArray = doc["Playfield"];
-            for (rapidjson::SizeType i = 0; i < playfieldArray.Size(); i++) {
-                const rapidjson::Value& cardObj = playfieldArray[i];
-                LevelConfig::CardItem cardConfig;
-                if (cardObj.HasMember("CardFace") && cardObj["CardFace"].IsInt()) {
-                    cardConfig.cardValue = static_cast<CardFaceType>(cardObj["CardFace"].GetInt());
-                }
-                if (cardObj.HasMember("CardSuit") && cardObj["CardSuit"].IsInt()) {
-                    cardConfig.cardSuit = static_cast<CardSuitType>(cardObj["CardSuit"].GetInt());
-                }
-                if (cardObj.HasMember("Position") && cardObj["Position"].IsObject()) {
-                    const rapidjson::Value& posObj = cardObj["Position"];
-                    if (posObj.HasMember("x") && posObj["x"].IsNumber() &&
-                        posObj.HasMember("y") && posObj["y"].IsNumber()) {
-                        cardConfig.cardPosition.x = posObj["x"].GetFloat();
-                        cardConfig.cardPosition.y = posObj["y"].GetFloat();
-                    }
-                }
-                playFieldCards.push_back(cardConfig);
-            }
-            levelConfig.setMainAreaCards(playFieldCards);  // 
-        }
+        levelConfig.setMainAreaCards(std::move(playFieldCards));  // 
+        levelConfig.setBackupAreaCards(std::move(stackCards));    // ñ
+        return true;
+    }
+
+    /**
+     * ؿлΪؿļͬʽJSONַ
+     * ؿɵ߹ level_N.json ʹ
+     * @param levelConfig ؿ
+     * @return JSONı
+     */
+    static std::string saveLevelConfigToString(const LevelConfig& levelConfig)
+    {
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        writer.SetIndent(' ', 4);
+
+        writer.StartObject();
+        writer.Key("Playfield");
+        writeCardItems(writer, levelConfig.getMainAreaCards());
+        writer.Key("Stack");
+        writeCardItems(writer, levelConfig.getBackupAreaCards());
+        writer.EndObject();
+
+        return std::string(buffer.GetString(), buffer.GetSize());
+    }
 
-        // 
-        if (doc.HasMember("Stack") && doc["Stack"].IsArray()) {
-            std::vector<LevelConfig::CardItem> stackCards;
-            const rapidjson::Value& stackArray = doc["Stack"];
-            for (rapidjson::SizeType i = 0; i < stackArray.Size(); i++) {
-                const rapidjson::Value& cardObj = stackArray[i];
-                LevelConfig::CardItem cardConfig;
-                if (cardObj.HasMember("CardFace") && cardObj["CardFace"].IsInt()) {
-                    cardConfig.cardValue = static_cast<CardFaceType>(cardObj["CardFace"].GetInt());
-                }
-                if (cardObj.HasMember("CardSuit") && cardObj["CardSuit"].IsInt()) {
-                    cardConfig.cardSuit = static_cast<CardSuitType>(cardObj["CardSuit"].GetInt());
-                }
-                // ƶѵλͨɳ㣬Ƕȡеλ
-                if (cardObj.HasMember("Position") && cardObj["Position"].IsObject()) {
-                    const rapidjson::Value& posObj = cardObj["Position"];
-                    if (posObj.HasMember("x") && posObj["x"].IsNumber() &&
-                        posObj.HasMember("y") && posObj["y"].IsNumber()) {
-                        cardConfig.cardPosition.x = posObj["x"].GetFloat();
-                        cardConfig.cardPosition.y = posObj["y"].GetFloat();
-                    }
-                }
-                stackCards.push_back(cardConfig);
-            }
-            levelConfig.setBackupAreaCards(stackCards);  // ñ
+private:
+    static bool openDefaultLevelPack(LevelPack& levelPack)
+    {
+        // ؿ LevelPacker ߴ level_N.json 
+        const std::string filename = "levels.pack";
+        return FileUtils::getInstance()->isFileExist(filename) && levelPack.open(filename);
+    }
+
+    // дһ鿨ã갴ддؿһ
+    static void writeCardItems(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer,
+        const std::vector<LevelConfig::CardItem>& cards)
+    {
+        writer.StartArray();
+        for (const auto& cardConfig : cards) {
+            writer.StartObject();
+            writer.Key("CardFace");
+            writer.Int(cardConfig.cardValue);
+            writer.Key("CardSuit");
+            writer.Int(cardConfig.cardSuit);
+            writer.Key("Position");
+            writer.StartObject();
+            writeCoordinate(writer, "x", cardConfig.cardPosition.x);
+            writeCoordinate(writer, "y", cardConfig.cardPosition.y);
+            writer.EndObject();
+            writer.EndObject();
         }
+        writer.EndArray();
+    }
 
-        return levelConfig;  // عLevelConfig
+    static void writeCoordinate(rapidjson::PrettyWriter<rapidjson::StringBuffer>& writer, const char* name, float value)
+    {
+        writer.Key(name);
+        if (value == static_cast<float>(static_cast<int>(value))) {
+            writer.Int(static_cast<int>(value));
+        }
+        else {
+            writer.Double(value);
+        }
     }
 };
 
@@ -0,0 +1,306 @@
+#pragma once
+#ifndef LEVEL_CONFIG_PARSER_H
+#define LEVEL_CONFIG_PARSER_H
+
+#include "cocos2d.h"
+#include "../models/LevelConfig.h"
+#include "json/reader.h"
+#include "json/error/en.h"
+#include <vector>
+#include <string>
+#include <cstring>
+
+/**
+ * Where and why parsing a level failed
+ */
+struct LevelParseError
+{
+    LevelParseError() : offset(0) {}
+
+    size_t offset;       // Byte offset into the JSON text
+    std::string message;
+};
+
+/**
+ * Streaming level JSON parser
+ * Runs a RapidJSON Reader over the level text in place and writes each
+ * card straight into caller supplied vectors, without building a DOM.
+ * Vectors are cleared but keep their capacity, so a caller that parses
+ * many levels allocates only when a level is bigger than any before it.
+ *
+ * Schema: {"Playfield": [card...], "Stack": [card...]} with
+ * card = {"CardFace": int, "CardSuit": int, "Position": {"x": num, "y": num}}.
+ * Unknown keys are skipped with their values; missing card fields keep
+ * CFT_NONE / CST_NONE / (0, 0). Type or range errors stop the parse.
+ */
+class LevelConfigParser
+{
+public:
+    /**
+     * Parse a level in place
+     * @param json Null-terminated JSON text, overwritten while parsing
+     * @param playfield Receives the Playfield cards
+     * @param stack Receives the Stack cards
+     * @param error Receives offset and message on failure, may be nullptr
+     * @return True on success
+     */
+    static bool parseInsitu(char* json, std::vector<LevelConfig::CardItem>& playfield,
+        std::vector<LevelConfig::CardItem>& stack, LevelParseError* error = nullptr)
+    {
+        playfield.clear();
+        stack.clear();
+
+        Handler handler(playfield, stack);
+        rapidjson::Reader reader;
+        rapidjson::InsituStringStream stream(json);
+        rapidjson::ParseResult result = reader.Parse<rapidjson::kParseInsituFlag>(stream, handler);
+        if (result.IsError()) {
+            if (error) {
+                error->offset = result.Offset();
+                error->message = handler.getMessage() ? handler.getMessage() : rapidjson::GetParseError_En(result.Code());
+            }
+            return false;
+        }
+        return true;
+    }
+
+private:
+    // SAX handler, a small state machine over the level schema
+    class Handler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, Handler>
+    {
+    public:
+        Handler(std::vector<LevelConfig::CardItem>& playfield, std::vector<LevelConfig::CardItem>& stack)
+            : _playfield(playfield), _stack(stack), _target(nullptr), _state(State::START),
+              _field(Field::NONE), _skipDepth(0), _message(nullptr)
+        {
+        }
+
+        const char* getMessage() const { return _message; }
+
+        bool StartObject()
+        {
+            if (_skipDepth > 0) {
+                _skipDepth++;
+                return true;
+            }
+            switch (_state) {
+            case State::START:
+                _state = State::ROOT;
+                return true;
+            case State::CARD_ARRAY:
+                _card.cardValue = CFT_NONE;
+                _card.cardSuit = CST_NONE;
+                _card.cardPosition = cocos2d::Vec2::ZERO;
+                _state = State::CARD;
+                return true;
+            case State::CARD:
+                if (_field == Field::POSITION) {
+                    _state = State::POSITION;
+                    _field = Field::NONE;
+                    return true;
+                }
+                return fail("unexpected object in card");
+            default:
+                return fail("unexpected object");
+            }
+        }
+
+        bool EndObject(rapidjson::SizeType)
+        {
+            if (_skipDepth > 0) {
+                skipContainerEnd();
+                return true;
+            }
+            switch (_state) {
+            case State::ROOT:
+                _state = State::DONE;
+                return true;
+            case State::CARD:
+                _target->push_back(_card);
+                _state = State::CARD_ARRAY;
+                return true;
+            case State::POSITION:
+                _state = State::CARD;
+                _field = Field::NONE;
+                return true;
+            default:
+                return fail("unexpected end of object");
+            }
+        }
+
+        bool StartArray()
+        {
+            if (_skipDepth > 0) {
+                _skipDepth++;
+                return true;
+            }
+            if (_state == State::START) {
+                return failTopLevel();
+            }
+            if (_state == State::ROOT && (_field == Field::PLAYFIELD || _field == Field::STACK)) {
+                _target = (_field == Field::PLAYFIELD) ? &_playfield : &_stack;
+                _target->clear();
+                _state = State::CARD_ARRAY;
+                _field = Field::NONE;
+                return true;
+            }
+            return fail(_state == State::ROOT ? "unexpected array" : "unexpected array in card");
+        }
+
+        bool EndArray(rapidjson::SizeType)
+        {
+            if (_skipDepth > 0) {
+                skipContainerEnd();
+                return true;
+            }
+            if (_state == State::CARD_ARRAY) {
+                _state = State::ROOT;
+                _target = nullptr;
+                return true;
+            }
+            return fail("unexpected end of array");
+        }
+
+        bool Key(const char* name, rapidjson::SizeType length, bool)
+        {
+            if (_skipDepth > 0) {
+                return true;
+            }
+            _field = Field::NONE;
+            switch (_state) {
+            case State::ROOT:
+                if (equals(name, length, "Playfield")) {
+                    _field = Field::PLAYFIELD;
+                }
+                else if (equals(name, length, "Stack")) {
+                    _field = Field::STACK;
+                }
+                break;
+            case State::CARD:
+                if (equals(name, length, "CardFace")) {
+                    _field = Field::CARD_FACE;
+                }
+                else if (equals(name, length, "CardSuit")) {
+                    _field = Field::CARD_SUIT;
+                }
+                else if (equals(name, length, "Position")) {
+                    _field = Field::POSITION;
+                }
+                break;
+            case State::POSITION:
+                if (equals(name, length, "x")) {
+                    _field = Field::X;
+                }
+                else if (equals(name, length, "y")) {
+                    _field = Field::Y;
+                }
+                break;
+            default:
+                return fail("unexpected key");
+            }
+            if (_field == Field::NONE) {
+                _skipDepth = 1; // Unknown key, skip its value
+            }
+            return true;
+        }
+
+        bool Int(int value) { return number(value, true); }
+        bool Uint(unsigned value) { return number(value, true); }
+        bool Int64(int64_t value) { return number(static_cast<double>(value), true); }
+        bool Uint64(uint64_t value) { return number(static_cast<double>(value), true); }
+        bool Double(double value) { return number(value, false); }
+
+        // Strings, booleans and nulls are only valid as skipped values
+        bool Default()
+        {
+            if (_skipDepth > 0) {
+                skipScalar();
+                return true;
+            }
+            if (_state == State::START) {
+                return failTopLevel();
+            }
+            return fail("unexpected value type");
+        }
+
+    private:
+        enum class State { START, ROOT, CARD_ARRAY, CARD, POSITION, DONE };
+        enum class Field { NONE, PLAYFIELD, STACK, CARD_FACE, CARD_SUIT, POSITION, X, Y };
+
+        static bool equals(const char* name, rapidjson::SizeType length, const char* expected)
+        {
+            return std::strlen(expected) == length && std::memcmp(name, expected, length) == 0;
+        }
+
+        bool number(double value, bool isInteger)
+        {
+            if (_skipDepth > 0) {
+                skipScalar();
+                return true;
+            }
+            if (_state == State::START) {
+                return failTopLevel();
+            }
+            Field field = _field;
+            _field = Field::NONE;
+            switch (field) {
+            case Field::CARD_FACE:
+                if (!isInteger || value < CFT_ACE || value >= CFT_NUM_CARD_FACE_TYPES) {
+                    return fail("CardFace must be an integer from 0 to 12");
+                }
+                _card.cardValue = static_cast<CardFaceType>(static_cast<int>(value));
+                return true;
+            case Field::CARD_SUIT:
+                if (!isInteger || value < CST_CLUBS || value >= CST_NUM_CARD_SUIT_TYPES) {
+                    return fail("CardSuit must be an integer from 0 to 3");
+                }
+                _card.cardSuit = static_cast<CardSuitType>(static_cast<int>(value));
+                return true;
+            case Field::X:
+                _card.cardPosition.x = static_cast<float>(value);
+                return true;
+            case Field::Y:
+                _card.cardPosition.y = static_cast<float>(value);
+                return true;
+            default:
+                return fail("unexpected number");
+            }
+        }
+
+        // A scalar ends the skip only when it is the skipped value itself
+        void skipScalar()
+        {
+            if (_skipDepth == 1) {
+                _skipDepth = 0;
+            }
+        }
+
+        // Closing the skipped container ends the skip
+        void skipContainerEnd()
+        {
+            if (--_skipDepth == 1) {
+                _skipDepth = 0;
+            }
+        }
+
+        bool fail(const char* message)
+        {
+            _message = message;
+            return false;
+        }
+
+        // A level file is one JSON object
+        bool failTopLevel() { return fail("expected an object at the top level"); }
+
+        std::vector<LevelConfig::CardItem>& _playfield;
+        std::vector<LevelConfig::CardItem>& _stack;
+        std::vector<LevelConfig::CardItem>* _target; // Array being filled
+        LevelConfig::CardItem _card;                  // Card being read
+        State _state;
+        Field _field;                                   // Field whose value comes next
+        int _skipDepth;                               // 0, or 1 + nesting of the value being skipped
+        const char* _message;                         // Schema error, nullptr for syntax errors
+    };
+};
+
+#endif // LEVEL_CONFIG_PARSER_H
@@ -0,0 +1,453 @@
+#pragma once
+#ifndef LEVEL_PACK_H
+#define LEVEL_PACK_H
+
+#include "cocos2d.h"
+#include "../models/LevelConfig.h"
+#include <vector>
+#include <map>
+#include <string>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if CC_TARGET_PLATFORM != CC_PLATFORM_WIN32 && CC_TARGET_PLATFORM != CC_PLATFORM_WINRT
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define LEVEL_PACK_USE_MMAP 1
+#elif CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+#include <windows.h>
+#define LEVEL_PACK_USE_MMAP 1
+#else
+#define LEVEL_PACK_USE_MMAP 0
+#endif
+
+/**
+ * Binary level pack format
+ *
+ *   LevelPackHeader
+ *   LevelPackIndexEntry[levelCount]  sorted by level id
+ *   card records[cardCount]          16 byte aligned, laid out exactly as LevelConfig::CardItem
+ *
+ * Every level owns a contiguous run of records, playfield first, then
+ * stack. Values are stored in the byte order of the writer; the header
+ * holds a byte order mark so a pack written on another byte order is
+ * rejected instead of misread. The checksum covers everything after the
+ * header.
+ */
+struct LevelPackHeader
+{
+    char magic[4];           // "LVPK"
+    uint32_t version;
+    uint32_t byteOrderMark;  // kByteOrderMark as written
+    uint32_t levelCount;
+    uint32_t cardCount;
+    uint32_t indexOffset;    // Byte offset of the index table
+    uint32_t cardsOffset;    // Byte offset of the first card record
+    uint32_t checksum;       // FNV-1a over [sizeof(LevelPackHeader), file size)
+};
+
+struct LevelPackIndexEntry
+{
+    int32_t levelId;
+    uint32_t firstCard;      // Index of the level's first card record
+    uint16_t fieldCount;     // Playfield records, followed by stackCount stack records
+    uint16_t stackCount;
+};
+
+static_assert(sizeof(LevelPackHeader) == 32, "LevelPackHeader layout is part of the file format");
+static_assert(sizeof(LevelPackIndexEntry) == 12, "LevelPackIndexEntry layout is part of the file format");
+
+// Card records are read in place as CardItem, so CardItem must keep the record layout
+static_assert(std::is_standard_layout<LevelConfig::CardItem>::value, "CardItem is mapped straight from level packs");
+static_assert(sizeof(LevelConfig::CardItem) == 16, "CardItem is mapped straight from level packs");
+static_assert(offsetof(LevelConfig::CardItem, cardSuit) == 4 && offsetof(LevelConfig::CardItem, cardPosition) == 8,
+    "CardItem is mapped straight from level packs");
+
+/**
+ * Constants and helpers shared by LevelPack and LevelPackWriter
+ */
+class LevelPackFormat
+{
+public:
+    static const uint32_t kVersion = 1;
+    static const uint32_t kByteOrderMark = 0x01020304;
+    static const uint32_t kCardAlignment = 16;
+
+    static bool hasMagic(const LevelPackHeader& header)
+    {
+        return std::memcmp(header.magic, "LVPK", 4) == 0;
+    }
+
+    static uint32_t checksum(const unsigned char* bytes, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+};
+
+/**
+ * Read-only view of a binary level pack
+ * The file is memory-mapped where the platform allows it (files inside an
+ * Android APK are read into one buffer instead). Levels are returned as
+ * CardItem spans pointing into the mapping, so opening a level neither
+ * parses nor allocates. Spans stay valid until the pack is closed.
+ */
+class LevelPack
+{
+public:
+    LevelPack()
+        : _bytes(nullptr), _size(0), _index(nullptr), _cards(nullptr), _levelCount(0)
+#if LEVEL_PACK_USE_MMAP && CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+        , _fileHandle(INVALID_HANDLE_VALUE), _mappingHandle(nullptr)
+#endif
+        , _mapped(false)
+    {
+    }
+
+    ~LevelPack() { close(); }
+
+    LevelPack(const LevelPack&) = delete;
+    LevelPack& operator=(const LevelPack&) = delete;
+
+    /**
+     * Open and validate a pack
+     * @param filename File name, resolved through FileUtils search paths
+     * @return True if the pack is open and its header, index and checksum are valid
+     */
+    bool open(const std::string& filename)
+    {
+        close();
+
+        std::string fullPath = cocos2d::FileUtils::getInstance()->fullPathForFilename(filename);
+        if (fullPath.empty()) {
+            CCLOG("LevelPack: file not found: %s", filename.c_str());
+            return false;
+        }
+
+        if (!mapFile(fullPath)) {
+            // Not mappable (e.g. inside the APK), keep one in-memory copy instead
+            _buffer = cocos2d::FileUtils::getInstance()->getDataFromFile(fullPath);
+            _bytes = _buffer.getBytes();
+            _size = static_cast<size_t>(_buffer.getSize());
+        }
+
+        if (!validate()) {
+            CCLOG("LevelPack: invalid level pack: %s", fullPath.c_str());
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void close()
+    {
+        unmapFile();
+        _buffer.clear();
+        _bytes = nullptr;
+        _size = 0;
+        _index = nullptr;
+        _cards = nullptr;
+        _levelCount = 0;
+    }
+
+    bool isOpen() const { return _index != nullptr; }
+
+    int getLevelCount() const { return static_cast<int>(_levelCount); }
+
+    /**
+     * Level id stored at an index position, in ascending id order
+     */
+    int getLevelId(int index) const { return _index[index].levelId; }
+
+    bool hasLevel(int levelId) const { return findLevel(levelId) != nullptr; }
+
+    /**
+     * Get the cards of a level without copying them
+     * @param levelId Level id
+     * @param playfield Receives the playfield cards
+     * @param stack Receives the stack cards, the last one starts active
+     * @return False if the pack holds no such level
+     */
+    bool getLevelCards(int levelId, LevelConfig::CardItemSpan& playfield, LevelConfig::CardItemSpan& stack) const
+    {
+        const LevelPackIndexEntry* entry = findLevel(levelId);
+        if (!entry) {
+            return false;
+        }
+        playfield = LevelConfig::CardItemSpan(_cards + entry->firstCard, entry->fieldCount);
+        stack = LevelConfig::CardItemSpan(_cards + entry->firstCard + entry->fieldCount, entry->stackCount);
+        return true;
+    }
+
+    /**
+     * Copy a level into a level configuration
+     * @return False if the pack holds no such level
+     */
+    bool loadLevelConfig(int levelId, LevelConfig& levelConfig) const
+    {
+        LevelConfig::CardItemSpan playfield;
+        LevelConfig::CardItemSpan stack;
+        if (!getLevelCards(levelId, playfield, stack)) {
+            return false;
+        }
+        levelConfig.setMainAreaCards(std::vector<LevelConfig::CardItem>(playfield.begin(), playfield.end()));
+        levelConfig.setBackupAreaCards(std::vector<LevelConfig::CardItem>(stack.begin(), stack.end()));
+        return true;
+    }
+
+private:
+    const LevelPackIndexEntry* findLevel(int levelId) const
+    {
+        if (!isOpen()) {
+            return nullptr;
+        }
+        const LevelPackIndexEntry* end = _index + _levelCount;
+        const LevelPackIndexEntry* entry = std::lower_bound(_index, end, levelId,
+            [](const LevelPackIndexEntry& item, int id) { return item.levelId < id; });
+        return (entry != end && entry->levelId == levelId) ? entry : nullptr;
+    }
+
+    bool validate()
+    {
+        if (!_bytes || _size < sizeof(LevelPackHeader)) {
+            return false;
+        }
+        const LevelPackHeader* header = reinterpret_cast<const LevelPackHeader*>(_bytes);
+        if (!LevelPackFormat::hasMagic(*header) || header->version != LevelPackFormat::kVersion ||
+            header->byteOrderMark != LevelPackFormat::kByteOrderMark) {
+            return false;
+        }
+
+        uint64_t indexEnd = header->indexOffset + static_cast<uint64_t>(header->levelCount) * sizeof(LevelPackIndexEntry);
+        uint64_t cardsEnd = header->cardsOffset + static_cast<uint64_t>(header->cardCount) * sizeof(LevelConfig::CardItem);
+        if (header->indexOffset < sizeof(LevelPackHeader) || header->indexOffset % alignof(LevelPackIndexEntry) != 0 ||
+            header->cardsOffset % LevelPackFormat::kCardAlignment != 0 ||
+            indexEnd > header->cardsOffset || cardsEnd != _size) {
+            return false;
+        }
+        if (header->checksum != LevelPackFormat::checksum(_bytes + sizeof(LevelPackHeader), _size - sizeof(LevelPackHeader))) {
+            return false;
+        }
+
+        const LevelPackIndexEntry* index = reinterpret_cast<const LevelPackIndexEntry*>(_bytes + header->indexOffset);
+        for (uint32_t i = 0; i < header->levelCount; ++i) {
+            uint64_t levelEnd = static_cast<uint64_t>(index[i].firstCard) + index[i].fieldCount + index[i].stackCount;
+            if (levelEnd > header->cardCount || (i > 0 && index[i - 1].levelId >= index[i].levelId)) {
+                return false;
+            }
+        }
+
+        _index = index;
+        _cards = reinterpret_cast<const LevelConfig::CardItem*>(_bytes + header->cardsOffset);
+        _levelCount = header->levelCount;
+        return true;
+    }
+
+#if LEVEL_PACK_USE_MMAP && CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    bool mapFile(const std::string& fullPath)
+    {
+        std::wstring widePath = cocos2d::StringUtils::StringUtf8ToWideChar(fullPath);
+        _fileHandle = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (_fileHandle == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(_fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+            unmapFile();
+            return false;
+        }
+        _mappingHandle = CreateFileMappingW(_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = _mappingHandle ? MapViewOfFile(_mappingHandle, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (!view) {
+            unmapFile();
+            return false;
+        }
+        _bytes = static_cast<const unsigned char*>(view);
+        _size = static_cast<size_t>(fileSize.QuadPart);
+        _mapped = true;
+        return true;
+    }
+
+    void unmapFile()
+    {
+        if (_mapped) {
+            UnmapViewOfFile(_bytes);
+            _mapped = false;
+        }
+        if (_mappingHandle) {
+            CloseHandle(_mappingHandle);
+            _mappingHandle = nullptr;
+        }
+        if (_fileHandle != INVALID_HANDLE_VALUE) {
+            CloseHandle(_fileHandle);
+            _fileHandle = INVALID_HANDLE_VALUE;
+        }
+    }
+#elif LEVEL_PACK_USE_MMAP
+    bool mapFile(const std::string& fullPath)
+    {
+        // Relative paths on Android point into the APK and cannot be mapped
+        if (!cocos2d::FileUtils::getInstance()->isAbsolutePath(fullPath)) {
+            return false;
+        }
+        int fd = ::open(fullPath.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat fileInfo;
+        void* view = MAP_FAILED;
+        if (fstat(fd, &fileInfo) == 0 && fileInfo.st_size > 0) {
+            view = mmap(nullptr, static_cast<size_t>(fileInfo.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        ::close(fd); // The mapping keeps its own reference to the file
+        if (view == MAP_FAILED) {
+            return false;
+        }
+        _bytes = static_cast<const unsigned char*>(view);
+        _size = static_cast<size_t>(fileInfo.st_size);
+        _mapped = true;
+        return true;
+    }
+
+    void unmapFile()
+    {
+        if (_mapped) {
+            munmap(const_cast<unsigned char*>(_bytes), _size);
+            _mapped = false;
+        }
+    }
+#else
+    bool mapFile(const std::string&) { return false; }
+    void unmapFile() {}
+#endif
+
+    const unsigned char* _bytes;         // Start of the mapping or of _buffer
+    size_t _size;
+    const LevelPackIndexEntry* _index;
+    const LevelConfig::CardItem* _cards;
+    uint32_t _levelCount;
+    cocos2d::Data _buffer;               // Used when the file could not be mapped
+#if LEVEL_PACK_USE_MMAP && CC_TARGET_PLATFORM == CC_PLATFORM_WIN32
+    HANDLE _fileHandle;
+    HANDLE _mappingHandle;
+#endif
+    bool _mapped;
+};
+
+/**
+ * Builds a binary level pack from level configurations
+ */
+class LevelPackWriter
+{
+public:
+    /**
+     * Add a level; a level id added twice keeps the last cards
+     * @return False if the level has more cards than a record count can hold
+     */
+    bool addLevel(int levelId, const LevelConfig& levelConfig)
+    {
+        const std::vector<LevelConfig::CardItem>& playfield = levelConfig.getMainAreaCards();
+        const std::vector<LevelConfig::CardItem>& stack = levelConfig.getBackupAreaCards();
+        if (playfield.size() > UINT16_MAX || stack.size() > UINT16_MAX) {
+            CCLOG("LevelPackWriter: level %d has too many cards", levelId);
+            return false;
+        }
+        PendingLevel& level = _levels[levelId];
+        level.playfield = playfield;
+        level.stack = stack;
+        return true;
+    }
+
+    int getLevelCount() const { return static_cast<int>(_levels.size()); }
+
+    /**
+     * Serialize every added level
+     * @return Pack bytes
+     */
+    std::vector<unsigned char> build() const
+    {
+        uint32_t cardCount = 0;
+        for (const auto& item : _levels) {
+            cardCount += static_cast<uint32_t>(item.second.playfield.size() + item.second.stack.size());
+        }
+
+        LevelPackHeader header;
+        std::memcpy(header.magic, "LVPK", 4);
+        header.version = LevelPackFormat::kVersion;
+        header.byteOrderMark = LevelPackFormat::kByteOrderMark;
+        header.levelCount = static_cast<uint32_t>(_levels.size());
+        header.cardCount = cardCount;
+        header.indexOffset = sizeof(LevelPackHeader);
+        uint32_t indexEnd = header.indexOffset + header.levelCount * sizeof(LevelPackIndexEntry);
+        header.cardsOffset = (indexEnd + LevelPackFormat::kCardAlignment - 1) / LevelPackFormat::kCardAlignment * LevelPackFormat::kCardAlignment;
+        header.checksum = 0;
+
+        std::vector<unsigned char> bytes(header.cardsOffset + cardCount * sizeof(LevelConfig::CardItem), 0);
+        LevelPackIndexEntry* index = reinterpret_cast<LevelPackIndexEntry*>(&bytes[header.indexOffset]);
+        unsigned char* records = &bytes[header.cardsOffset];
+        uint32_t nextCard = 0;
+        for (const auto& item : _levels) {
+            index->levelId = item.first;
+            index->firstCard = nextCard;
+            index->fieldCount = static_cast<uint16_t>(item.second.playfield.size());
+            index->stackCount = static_cast<uint16_t>(item.second.stack.size());
+            index++;
+            for (const auto& card : item.second.playfield) {
+                writeRecord(records + nextCard++ * sizeof(LevelConfig::CardItem), card);
+            }
+            for (const auto& card : item.second.stack) {
+                writeRecord(records + nextCard++ * sizeof(LevelConfig::CardItem), card);
+            }
+        }
+
+        header.checksum = LevelPackFormat::checksum(bytes.data() + sizeof(LevelPackHeader), bytes.size() - sizeof(LevelPackHeader));
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        return bytes;
+    }
+
+    /**
+     * Build the pack and write it to a file
+     * @param fullPath Output path
+     * @return True on success
+     */
+    bool saveToFile(const std::string& fullPath) const
+    {
+        std::vector<unsigned char> bytes = build();
+        cocos2d::Data data;
+        data.copy(bytes.data(), static_cast<ssize_t>(bytes.size()));
+        return cocos2d::FileUtils::getInstance()->writeDataToFile(data, fullPath);
+    }
+
+private:
+    struct PendingLevel
+    {
+        std::vector<LevelConfig::CardItem> playfield;
+        std::vector<LevelConfig::CardItem> stack;
+    };
+
+    // Field by field, so padding or stray enum bits never reach the file
+    static void writeRecord(unsigned char* record, const LevelConfig::CardItem& card)
+    {
+        int32_t face = card.cardValue;
+        int32_t suit = card.cardSuit;
+        float x = card.cardPosition.x;
+        float y = card.cardPosition.y;
+        std::memcpy(record + offsetof(LevelConfig::CardItem, cardValue), &face, sizeof(face));
+        std::memcpy(record + offsetof(LevelConfig::CardItem, cardSuit), &suit, sizeof(suit));
+        std::memcpy(record + offsetof(LevelConfig::CardItem, cardPosition), &x, sizeof(x));
+        std::memcpy(record + offsetof(LevelConfig::CardItem, cardPosition) + sizeof(float), &y, sizeof(y));
+    }
+
+    std::map<int, PendingLevel> _levels; // Ordered by level id, as the index requires
+};
+
+#endif // LEVEL_PACK_H
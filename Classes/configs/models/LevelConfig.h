@@ -22,6 +22,21 @@ public:
         cocos2d::Vec2 cardPosition; // Ƭλ
     };
 
+    // ֻĿƬͼݣֱָڴӳĹؿ
+    struct CardItemSpan
+    {
+        CardItemSpan() : data(nullptr), size(0) {}
+        CardItemSpan(const CardItem* items, size_t count) : data(items), size(count) {}
+
+        const CardItem* begin() const { return data; }
+        const CardItem* end() const { return data + size; }
+        const CardItem& operator[](size_t index) const { return data[index]; }
+        bool empty() const { return size == 0; }
+
+        const CardItem* data;
+        size_t size;
+    };
+
     // ȡ LevelConfig ĵʵ
     static LevelConfig& getInstance()
     {
@@ -32,20 +47,22 @@ public:
     // ȡҪĿƬ
     const std::vector<CardItem>& getMainAreaCards() const { return _mainAreaCards; }
     void setMainAreaCards(const std::vector<CardItem>& cards) { _mainAreaCards = cards; }
+    void setMainAreaCards(std::vector<CardItem>&& cards) { _mainAreaCards = std::move(cards); }
 
     // ȡñĿƬ
     const std::vector<CardItem>& getBackupAreaCards() const { return _backupAreaCards; }
     void setBackupAreaCards(const std::vector<CardItem>& cards) { _backupAreaCards = cards; }
+    void setBackupAreaCards(std::vector<CardItem>&& cards) { _backupAreaCards = std::move(cards); }
 
     // ɾ캯͸ֵȷɸ
     LevelConfig(const LevelConfig&) = delete;
     LevelConfig& operator=(const LevelConfig&) = delete;
 
-private:
-    // ˽й캯ȷⲿ޷ֱӴʵ
+    // УȹҪͬʱжؿڵ֮ʵ
     LevelConfig() {}
     ~LevelConfig() = default;
 
+private:
     std::vector<CardItem> _mainAreaCards; // ҪƬ
     std::vector<CardItem> _backupAreaCards; // Ƭ
 };
@@ -4,10 +4,21 @@
 #include "cocos2d.h"
 #include "../models/GameModel.h"
 #include "../views/GameView.h"
+#include "../views/IGameView.h"
 #include "../managers/UndoManager.h"
+#include "../managers/GameSaveManager.h"
+#include "../managers/LevelConfigCache.h"
 #include "../configs/loaders/LevelConfigLoader.h"
 #include "../services/GameModelFromLevelGenerator.h"
+#include "../services/MoveGenerator.h"
+#include "../services/HintSearch.h"
+#include "../services/ReplaySimulator.h"
 #include "../utils/GameUtils.h"
+#include "../utils/GameRandom.h"
+#include "../utils/CardResourceTable.h"
+#include "base/CCAsyncTaskPool.h"
+#include <atomic>
+#include <memory>
 
 // Forward declarations
 class LevelConfigLoader;
@@ -16,12 +27,24 @@ class GameModelFromLevelGenerator;
 /**
  * Game controller
  * Manages the game flow and coordinates interactions between modules
+ *
+ * Moves change the model at once; the view is only told what to show.
+ * Given a view of its own, e.g. a HeadlessGameView, the controller runs
+ * headless: it creates no GameView and does not prefetch levels on the
+ * task pool, which reports back through the Director. Hints and replay
+ * playback still need the Director.
  */
 class GameController
 {
 public:
-    GameController()
-        : _currentGameModel(nullptr), _currentGameView(nullptr), _historyManager(nullptr), _levelGenerator(nullptr)
+    /**
+     * @param gameView View to play against, owned by the caller; nullptr
+     *                 to create a GameView for the scene
+     */
+    explicit GameController(IGameView* gameView = nullptr)
+        : _currentGameModel(nullptr), _currentGameView(gameView), _nodeGameView(nullptr), _historyManager(nullptr),
+          _levelGenerator(nullptr), _headless(gameView != nullptr), _wrapAround(false), _moveCount(0), _replayCursor(0),
+          _replaying(false)
     {
         _historyManager = new UndoManager();
         _levelGenerator = new GameModelFromLevelGenerator();
@@ -29,8 +52,14 @@ public:
 
     ~GameController()
     {
+        stopReplay();
+        // A search still running must not report back to this controller
+        if (_pendingHint) {
+            _pendingHint->cancelled = true;
+        }
+        logGameStats();
         delete _currentGameModel;
-        delete _currentGameView;
+        delete _nodeGameView;
         delete _historyManager;
         delete _levelGenerator;
     }
@@ -41,36 +70,54 @@ public:
      */
     void beginGame(int levelId)
     {
-        CCLOG("GameController: Starting game with level %d", levelId);
+        startGame(levelId, nullptr, nullptr, GameRandom::makeSeed());
+    }
 
-        // 1. Load level configuration
-        auto& levelConfig = LevelConfigLoader::loadLevelConfig(levelId);
+    /**
+     * Start a new game on a level that is not in the game's level files,
+     * e.g. a generated one
+     * @param levelId Level ID to record the game under
+     * @param levelConfig Level configuration
+     * @param seed Seed of the game's random numbers, a fresh one by default
+     * @return True if the game is set up
+     */
+    bool beginGame(int levelId, const LevelConfigPtr& levelConfig, uint32_t seed = GameRandom::makeSeed())
+    {
+        return levelConfig && startGame(levelId, levelConfig, nullptr, seed);
+    }
 
-        // 2. Generate game model from level configuration
-        _currentGameModel = _levelGenerator->createGameModelFromLevel(levelConfig);
+    /**
+     * Continue a saved game
+     * @param snapshot Game saved by saveGame()
+     * @return False if the save does not fit its level, nothing is set up then
+     */
+    bool resumeGame(const GameSnapshot& snapshot)
+    {
+        return startGame(snapshot.getLevelId(), nullptr, &snapshot, 0);
+    }
 
+    /**
+     * Save the game in progress, e.g. when the app goes to the background
+     * The file is written on the IO thread. A cleared game removes the save
+     * instead, so the next launch starts over.
+     */
+    void saveGame()
+    {
         if (!_currentGameModel) {
-            CCLOG("GameController: Failed to generate game model");
             return;
         }
 
-        // 3. Create game view
-        _currentGameView = GameView::create();
-        if (!_currentGameView) {
-            CCLOG("GameController: Failed to create game view");
+        GameSaveManager& saveManager = GameSaveManager::getInstance();
+        if (_currentGameModel->getFieldCards().empty()) {
+            saveManager.removeSave();
             return;
         }
 
-        // 4. Set up callbacks
-        initializeViewCallbacks();
-
-        // 5. Update the game view
-        _currentGameView->updateDisplay(_currentGameModel);
-
-        // 6. Initialize history manager
-        _historyManager->setup();
-
-        CCLOG("GameController: Game started successfully");
+        GameSnapshot snapshot;
+        if (GameSaveManager::captureSnapshot(*_currentGameModel, *_historyManager, _replayCardIndex,
+            _replay.getLevelId(), snapshot)) {
+            saveManager.saveAsync(snapshot);
+        }
     }
 
     /**
@@ -95,12 +142,22 @@ public:
             return false;
         }
 
+        // Only field cards with nothing on top of them can be matched
+        if (!_currentGameModel->isCardPlayable(cardId)) {
+            CCLOG("GameController: Card %d is covered", cardId);
+            return false;
+        }
+
         // Check if the cards match
         if (areCardsMatching(selectedCard, currentBottomCard)) {
             CCLOG("GameController: Cards match! %d and %d", selectedCard->getCardValue(), currentBottomCard->getCardValue());
 
             // Execute match handling
-            processCardMatch(selectedCard, currentBottomCard);
+            onPlayerMove();
+            if (!processCardMatch(selectedCard)) {
+                return false;
+            }
+            _replay.addEvent(ReplayEvent::make(ReplayEventType::MATCH, _replayCardIndex.getIndex(cardId)));
             return true;
         }
         else {
@@ -128,243 +185,524 @@ public:
         CCLOG("GameController: Drawing card from stack");
 
         // Draw a card from the stack
-        drawCardFromDeck();
+        onPlayerMove();
+        if (drawCardFromDeck()) {
+            _replay.addEvent(ReplayEvent::make(ReplayEventType::DRAW));
+        }
     }
 
     /**
      * Handle undo operation
+     * Reverts the last move in place, only the cards it moved change.
      */
     void handleUndo()
     {
         if (!_currentGameModel || !_currentGameView || !_historyManager->hasUndoableActions()) {
-            CCLOG("GameController: Cannot undo - gameModel=%p, gameView=%p, canUndo=%d",
-                _currentGameModel, _currentGameView, _historyManager ? _historyManager->hasUndoableActions() : false);
+            CCLOG("GameController: Cannot undo - gameModel=%p, gameView=%p",
+                _currentGameModel, _currentGameView);
             return;
         }
 
-        UndoModel* undoModel = _historyManager->removeUndoRecord();
-        if (!undoModel) {
-            CCLOG("GameController: No undo record found");
+        const MoveRecord* move = _historyManager->popUndoRecord();
+        CCLOG("GameController: Undoing operation type: %d", (int)move->type);
+
+        onPlayerMove();
+        if (!_currentGameModel->revertMove(*move)) {
+            _historyManager->cancelUndo();
             return;
         }
+        _replay.addEvent(ReplayEvent::make(ReplayEventType::UNDO));
+        _currentGameView->updateDisplay(_currentGameModel);
+    }
 
-        CCLOG("GameController: Undoing operation type: %d", (int)undoModel->getOperationType());
+    /**
+     * Handle redo operation
+     * Plays the last undone move again, until a new move is made.
+     */
+    void handleRedo()
+    {
+        if (!_currentGameModel || !_currentGameView || !_historyManager->hasRedoableActions()) {
+            CCLOG("GameController: Nothing to redo");
+            return;
+        }
 
-        // Perform undo based on operation type
-        undoPreviousAction(undoModel);
+        MoveRecord move = *_historyManager->popRedoRecord();
+        CCLOG("GameController: Redoing operation type: %d", (int)move.type);
 
-        delete undoModel;
+        onPlayerMove();
+        if (!_currentGameModel->applyMove(move)) {
+            _historyManager->cancelRedo();
+            return;
+        }
+        _replay.addEvent(ReplayEvent::make(ReplayEventType::REDO));
+        _currentGameView->updateDisplay(_currentGameModel);
     }
 
     /**
-     * Get the game view (to add to the scene)
+     * The session so far, for support reports and replays
+     * Seals the recording with the hash of the current state, which
+     * ReplaySimulator checks a headless run against.
      */
-    cocos2d::Node* getGameView() const { return _currentGameView; }
+    const ReplayModel& getReplay()
+    {
+        if (_currentGameModel) {
+            _replay.setFinalHash(ReplaySimulator::hashGameState(*_currentGameModel, _replayCardIndex));
+        }
+        return _replay;
+    }
 
     /**
-     * Get the current game model (for debugging)
+     * Play a recorded session back in the view
+     * The current game goes back to the start of the level and the inputs
+     * are fed through the usual entry points, one per step. The speed scales
+     * the scheduler, so card animations fast-forward with the steps. Player
+     * input is ignored until the playback ends. A headless controller has no
+     * scheduler and plays the whole session before returning.
+     * @param replay Session recorded on the current level, may be getReplay()
+     * @param speed Playback speed, 1 to 16 times
+     * @return False if the replay belongs to another level
      */
-    GameModel* getGameModel() const { return _currentGameModel; }
+    bool playReplay(const ReplayModel& replay, float speed)
+    {
+        if (!_currentGameModel || !_currentGameView || replay.getLevelId() != _replay.getLevelId()) {
+            CCLOG("GameController: Replay of level %d does not fit the current game", replay.getLevelId());
+            return false;
+        }
+
+        // Taken before the restart, which clears the recording the replay may be
+        std::vector<ReplayEvent> events = replay.getEvents();
+        int levelId = replay.getLevelId();
+        uint32_t seed = replay.getSeed();
+
+        stopReplay();
+        restartGame();
+
+        // The session draws the random numbers it drew when it was recorded
+        _currentGameModel->setSeed(seed);
+        _replay.reset(levelId, seed);
+
+        _replayEvents.swap(events);
+        _replayCursor = 0;
+        _replaying = true;
+
+        if (_headless) {
+            while (_replaying) {
+                stepReplay();
+            }
+            return true;
+        }
+
+        cocos2d::Scheduler* scheduler = cocos2d::Director::getInstance()->getScheduler();
+        float timeScale = speed < kMinReplaySpeed ? kMinReplaySpeed : (speed > kMaxReplaySpeed ? kMaxReplaySpeed : speed);
+        scheduler->setTimeScale(timeScale);
+        scheduler->schedule([this](float) { this->stepReplay(); }, this, kReplayStepSeconds, false, kReplayScheduleKey);
+        return true;
+    }
 
-private:
     /**
-     * Set up view callbacks
+     * End a playback early, the game stays where it got to
      */
-    void initializeViewCallbacks()
+    void stopReplay()
     {
-        _currentGameView->setCardClickCallback([this](int cardId) {
-            this->handleCardSelection(cardId);
-            });
-
-        _currentGameView->setReserveClickCallback([this]() {
-            this->handleCardDraw();
-            });
+        if (!_replaying) {
+            return;
+        }
+        _replaying = false;
+        if (_headless) {
+            return;
+        }
+        cocos2d::Scheduler* scheduler = cocos2d::Director::getInstance()->getScheduler();
+        scheduler->unschedule(kReplayScheduleKey, this);
+        scheduler->setTimeScale(1.0f);
     }
 
+    bool isReplaying() const { return _replaying; }
+
     /**
-     * Check if two cards match
-     * @param card1 Card 1
-     * @param card2 Card 2
-     * @return True if they match
+     * Ask for a hint
+     * A bounded lookahead runs on a background thread and never blocks
+     * the render loop. Its answer comes back on the cocos thread and makes
+     * the suggested card blink; it is dropped if the player moves first or
+     * asks again. A running search is cancelled by the next request.
+     * @return True if a search was started
      */
-    bool areCardsMatching(const CardModel* card1, const CardModel* card2) const
+    bool requestHint()
     {
-        if (!card1 || !card2) {
+        if (!_currentGameModel || !_currentGameView) {
             return false;
         }
 
-        int value1 = card1->getCardValue();
-        int value2 = card2->getCardValue();
+        cancelHint();
 
-        return GameUtils::areCardsAdjacent(value1, value2);
+        // Snapshot the game here, the search only reads its own copy
+        HintOptions options;
+        options.budgetMs = kHintBudgetMs;
+        options.wrapAround = _wrapAround;
+        std::shared_ptr<PendingHint> hint = std::make_shared<PendingHint>(options, _moveCount);
+        if (!hint->search.prepare(*_currentGameModel)) {
+            return false;
+        }
+        _pendingHint = hint;
+
+        GameController* controller = this;
+        cocos2d::AsyncTaskPool::getInstance()->enqueue(cocos2d::AsyncTaskPool::TaskType::TASK_OTHER,
+            [hint, controller]() {
+                HintResult result = hint->search.search(&hint->cancelled);
+                cocos2d::Director::getInstance()->getScheduler()->performFunctionInCocosThread([hint, controller, result]() {
+                    // Set on the cocos thread before the controller goes away
+                    if (!hint->cancelled) {
+                        controller->finishHint(hint, result);
+                    }
+                    });
+            });
+        return true;
     }
 
     /**
-     * Process card match
-     * @param selectedCard Clicked card
-     * @param currentBottomCard Current bottom card
+     * Let kings and aces match each other
+     * Applies to the player's matches and to hints. A replay recorded with the
+     * rule on only verifies with ReplaySimulator::setWrapAround(true).
      */
-    void processCardMatch(CardModel* selectedCard, CardModel* currentBottomCard)
-    {
-        // Record previous positions
-        cocos2d::Vec2 selectedCardPosition = selectedCard->getLocation();
+    void setWrapAround(bool wrapAround) { _wrapAround = wrapAround; }
+    bool isWrapAround() const { return _wrapAround; }
 
-        // Create undo record
-        UndoModel* undoModel = new UndoModel();
-        undoModel->setOperationType(ActionType::MATCH_CARD);
-        undoModel->setMatchedCardId(selectedCard->getItemId());
-        undoModel->setPreviousBottomCardId(currentBottomCard->getItemId());
-        undoModel->setMatchedCardPosition(selectedCardPosition);
-        undoModel->setPreviousBottomPosition(cocos2d::Vec2::ZERO); // Bottom card is at (0,0)
+    /**
+     * Get the game view (to add to the scene), nullptr when headless
+     */
+    cocos2d::Node* getGameView() const { return _currentGameView ? _currentGameView->getNode() : nullptr; }
 
-        _historyManager->addUndoRecord(undoModel);
+    /**
+     * Get the current game model (for debugging)
+     */
+    GameModel* getGameModel() const { return _currentGameModel; }
 
-        // Immediately remove card from play field
-        _currentGameModel->setCardAction(new RemoveCardAction(selectedCard->getItemId()));
-        _currentGameModel->performCardAction();
+private:
+    // A hint search in flight, shared with its background task
+    struct PendingHint
+    {
+        PendingHint(const HintOptions& options, unsigned int moveCount)
+            : search(options), moveCount(moveCount), cancelled(false)
+        {
+        }
 
-        // Play card move animation to the bottom position
-        animateCardMovement(selectedCard, currentBottomCard);
-    }
+        HintSearch search;
+        unsigned int moveCount; // Player moves made when the hint was asked for
+        std::atomic<bool> cancelled;
+    };
 
     /**
-     * Play the card move animation
-     * @param selectedCard Clicked card
-     * @param currentBottomCard Current bottom card
+     * Start a game from its level, or from a save of it
+     * @param levelId Level ID
+     * @param levelConfig Level configuration, nullptr to load the level's file
+     * @param snapshot Save to continue, nullptr for a new game
+     * @param seed Seed of a new game's random numbers; a save keeps its own
+     * @return True if the game is set up
      */
-    void animateCardMovement(CardModel* selectedCard, CardModel* currentBottomCard)
+    bool startGame(int levelId, const LevelConfigPtr& levelConfig, const GameSnapshot* snapshot, uint32_t seed)
     {
-        // Calculate target position
-        auto bottomNodeWorldPos = _currentGameView->getFooterNode()->convertToWorldSpace(cocos2d::Vec2::ZERO);
-        auto playFieldNode = _currentGameView->getMainAreaNode();
-        auto targetInPlayField = playFieldNode->convertToNodeSpace(bottomNodeWorldPos);
+        CCLOG("GameController: Starting game with level %d", levelId);
 
-        // Play animation
-        _currentGameView->animateCardMovement(
-            selectedCard->getItemId(),
-            targetInPlayField,
-            0.5f,
-            [this, selectedCard, currentBottomCard]() {
-                // After animation, update the model
-                // Place the previous bottom card back into the stack
-                if (currentBottomCard) {
-                    std::vector<CardModel*> stackCards = _currentGameModel->getReserveCards();
-                    stackCards.insert(stackCards.begin(), currentBottomCard);
-                    _currentGameModel->setReserveCards(stackCards);
-                }
-
-                // Set new bottom card and update location
-                selectedCard->setLocation(cocos2d::Vec2::ZERO); // Position at the bottom card node
-                _currentGameModel->setActiveCard(selectedCard);
-
-                // Update view
-                this->_currentGameView->updateDisplay(this->_currentGameModel);
-                CCLOG("GameController: Card moved to bottom successfully");
+        // A game in progress is dropped, so one controller can play game after game
+        stopReplay();
+        cancelHint();
+        logGameStats();
+        delete _currentGameModel;
+        _currentGameModel = nullptr;
+
+        // 1. Load level configuration (a cache hit once the level was prefetched)
+        if (levelConfig) {
+            _currentLevelConfig = levelConfig;
+        }
+        else {
+            LevelConfigCache& levelCache = LevelConfigCache::getInstance();
+            _currentLevelConfig = levelCache.getLevelConfig(levelId);
+            if (!_currentLevelConfig) {
+                CCLOG("GameController: Failed to load level %d", levelId);
+                return false;
+            }
+
+            // Load the following levels in the background while this one is played
+            if (!_headless) {
+                levelCache.prefetch(levelId + 1, kPrefetchLevelCount);
+            }
+        }
+
+        // 2. Generate game model from level configuration, or rebuild the saved one with its history
+        if (snapshot) {
+            _currentGameModel = GameSaveManager::restoreSnapshot(*snapshot, *_currentLevelConfig, *_historyManager,
+                _replayCardIndex, _wrapAround);
+        }
+        else {
+            _historyManager->setup();
+            _currentGameModel = _levelGenerator->createGameModelFromLevel(*_currentLevelConfig);
+            if (_currentGameModel) {
+                _currentGameModel->setSeed(seed);
+                _replayCardIndex.build(*_currentGameModel);
             }
-        );
+        }
+
+        if (!_currentGameModel) {
+            CCLOG("GameController: Failed to generate game model");
+            return false;
+        }
+
+        // 3. Create game view, unless the controller plays against its own
+        if (!_currentGameView && !createNodeGameView()) {
+            CCLOG("GameController: Failed to create game view");
+            return false;
+        }
+
+        // 4. Set up callbacks
+        initializeViewCallbacks();
+
+        // 5. Update the game view, dropping what it showed of a previous game
+        _currentGameView->clearDisplay();
+        _currentGameView->updateDisplay(_currentGameModel);
+
+        // 6. Start recording under the game's seed.
+        // A resumed game starts its recording with the saved moves.
+        _replay.reset(levelId, _currentGameModel->getSeed());
+        if (snapshot) {
+            recordSavedMoves(*snapshot);
+        }
+
+        CCLOG("GameController: Game started successfully");
+        return true;
     }
 
-    /**
-     * Draw a card from the stack and update the view
-     */
-    void drawCardFromDeck()
+    // Replay events that lead to a saved game: every move, then undos back to its cursor
+    void recordSavedMoves(const GameSnapshot& snapshot)
     {
-        // Record previous bottom card
-        CardModel* previousBottomCard = _currentGameModel->getActiveCard();
-
-        // Draw a card from the reserve deck
-        _currentGameModel->setCardAction(new DrawCardAction());
-        CardModel* drawnCard = _currentGameModel->performDrawCardAction();
-        if (drawnCard) {
-            // Create undo record
-            UndoModel* undoModel = new UndoModel();
-            undoModel->setOperationType(ActionType::DRAW_CARD);
-            if (previousBottomCard) {
-                undoModel->setPreviousBottomCardId(previousBottomCard->getItemId());
+        const std::vector<uint8_t>& moves = snapshot.getMoves();
+        for (uint8_t code : moves) {
+            if (code == GameSnapshot::kDrawMove) {
+                _replay.addEvent(ReplayEvent::make(ReplayEventType::DRAW));
             }
-            undoModel->setNewBottomCardId(drawnCard->getItemId());
-
-            _historyManager->addUndoRecord(undoModel);
+            else {
+                _replay.addEvent(ReplayEvent::make(ReplayEventType::MATCH, code - GameSnapshot::kMatchBase));
+            }
+        }
+        for (size_t i = snapshot.getMoveCursor(); i < moves.size(); ++i) {
+            _replay.addEvent(ReplayEvent::make(ReplayEventType::UNDO));
+        }
+    }
 
-            // Play animation
-            animateCardMovement(drawnCard, previousBottomCard);
+    // The scene's view, with card images and card views ready for the level
+    bool createNodeGameView()
+    {
+        _nodeGameView = GameView::create();
+        if (!_nodeGameView) {
+            return false;
         }
+
+        // Resolve card images once: prebaked atlas faces, so every card draws as
+        // one quad from one texture, and the loose images as a fallback
+        CardResourceTable::getInstance().load();
+
+        // Every field card plus the active and reserve cards can be on screen at once
+        _nodeGameView->prewarmCardViews(_currentGameModel->getFieldCards().size() + 2);
+        _currentGameView = _nodeGameView;
+        return true;
     }
 
-    /**
-     * Undo the operation
-     * @param undoModel Undo record
-     */
-    void undoPreviousAction(UndoModel* undoModel)
+    // Feed the next recorded input to its entry point
+    void stepReplay()
     {
-        switch (undoModel->getOperationType()) {
-        case ActionType::MATCH_CARD:
-            processCardUndo(undoModel);
+        if (_replayCursor >= _replayEvents.size()) {
+            stopReplay();
+            return;
+        }
+
+        const ReplayEvent& event = _replayEvents[_replayCursor++];
+        switch (event.getType()) {
+        case ReplayEventType::MATCH:
+            handleCardSelection(_replayCardIndex.getCardId(event.getCardIndex()));
+            break;
+        case ReplayEventType::DRAW:
+            handleCardDraw();
             break;
-        case ActionType::DRAW_CARD:
-            processCardDrawUndo(undoModel);
+        case ReplayEventType::UNDO:
+            handleUndo();
             break;
-        default:
-            CCLOG("GameController: Unknown operation type for undo");
+        case ReplayEventType::REDO:
+            handleRedo();
             break;
         }
     }
 
+    // Take back every move, leaving the level as it was dealt
+    void restartGame()
+    {
+        onPlayerMove();
+        while (_historyManager->hasUndoableActions()) {
+            _currentGameModel->revertMove(*_historyManager->popUndoRecord());
+        }
+        _historyManager->reset();
+        _currentGameModel->restartRandom();
+        _replay.reset(_replay.getLevelId(), _currentGameModel->getSeed());
+        _currentGameView->updateDisplay(_currentGameModel);
+    }
+
+    // Memory use of a game, logged once when it is dropped
+    void logGameStats() const
+    {
+        if (!_currentGameModel) {
+            return;
+        }
+        CCLOG("GameController: Arena heap allocations=%d, objects=%d, move log %d bytes",
+            (int)_currentGameModel->getArena().getStats().heapAllocations,
+            (int)_currentGameModel->getArena().getStats().allocations,
+            (int)_historyManager->getMemoryUsage());
+        if (_nodeGameView) {
+            CCLOG("GameController: Card view pool hits=%d, misses=%d",
+                (int)_nodeGameView->getCardViewPool().getHitCount(), (int)_nodeGameView->getCardViewPool().getMissCount());
+        }
+    }
+
+    // Every match, draw, undo and redo makes a pending or shown hint stale
+    void onPlayerMove()
+    {
+        _moveCount++;
+        cancelHint();
+    }
+
+    void cancelHint()
+    {
+        if (_pendingHint) {
+            _pendingHint->cancelled = true;
+            _pendingHint.reset();
+        }
+        if (_currentGameView) {
+            _currentGameView->clearHint();
+        }
+    }
+
+    // Show a search result if it still answers the latest request
+    void finishHint(const std::shared_ptr<PendingHint>& hint, const HintResult& result)
+    {
+        if (hint != _pendingHint || hint->moveCount != _moveCount) {
+            return; // Stale
+        }
+        _pendingHint.reset();
+        if (!result.found) {
+            CCLOG("GameController: No move left to hint");
+            return;
+        }
+        CCLOG("GameController: Hint %s card %d (depth %d, %d nodes)",
+            result.move.type == ActionType::MATCH_CARD ? "match" : "draw", result.move.cardId,
+            result.depth, (int)result.nodes);
+        _currentGameView->showHint(result.move.cardId);
+    }
+
     /**
-     * Undo card match
-     * @param undoModel Undo record
+     * Set up view callbacks
      */
-    void processCardUndo(UndoModel* undoModel)
+    void initializeViewCallbacks()
     {
-        CardModel* matchedCard = _currentGameModel->getCardById(undoModel->getMatchedCardId());
-        CardModel* previousBottomCard = _currentGameModel->getCardById(undoModel->getPreviousBottomCardId());
-
-        if (matchedCard && previousBottomCard) {
-            // Restore the matched card to the play field
-            matchedCard->setLocation(undoModel->getMatchedCardPosition());
-            std::vector<CardModel*> playFieldCards = _currentGameModel->getFieldCards();
-            playFieldCards.push_back(matchedCard);
-            _currentGameModel->setFieldCards(playFieldCards);
+        _currentGameView->setCardClickCallback([this](int cardId) {
+            if (!this->_replaying) {
+                this->handleCardSelection(cardId);
+            }
+            });
 
-            // Restore the previous bottom card
-            previousBottomCard->setLocation(cocos2d::Vec2::ZERO); // At bottom card node center
-            _currentGameModel->setActiveCard(previousBottomCard);
+        _currentGameView->setReserveClickCallback([this]() {
+            if (!this->_replaying) {
+                this->handleCardDraw();
+            }
+            });
+    }
 
-            // Update the view
-            _currentGameView->updateDisplay(_currentGameModel);
+    /**
+     * Check if two cards match
+     * Uses the same face adjacency table as the solver's move generation.
+     * @param card1 Card 1
+     * @param card2 Card 2
+     * @return True if they match
+     */
+    bool areCardsMatching(const CardModel* card1, const CardModel* card2) const
+    {
+        if (!card1 || !card2) {
+            return false;
         }
+
+        return MoveGenerator::areFacesAdjacent(card1->getFaceType(), card2->getFaceType(), _wrapAround);
     }
 
     /**
-     * Undo card draw
-     * @param undoModel Undo record
+     * Process card match
+     * The model takes the move at once and the view shows it in the same
+     * frame; only the card's flight to the bottom position is left to run,
+     * and the next move cuts it short. Input is never held back.
+     * @param selectedCard Clicked card
+     * @return True if the match was played
      */
-    void processCardDrawUndo(UndoModel* undoModel)
+    bool processCardMatch(CardModel* selectedCard)
     {
-        CardModel* newBottomCard = _currentGameModel->getCardById(undoModel->getNewBottomCardId());
-        CardModel* previousBottomCard = _currentGameModel->getCardById(undoModel->getPreviousBottomCardId());
+        MoveRecord move = MoveRecord::match(selectedCard->getItemId());
+        if (!_currentGameModel->applyMove(move)) {
+            return false;
+        }
+        _historyManager->addUndoRecord(move);
 
-        if (newBottomCard && previousBottomCard) {
-            // Return drawn card to the stack and restore previous bottom card
-            newBottomCard->setReversed(false);
-            std::vector<CardModel*> stackCards = _currentGameModel->getReserveCards();
-            stackCards.push_back(newBottomCard);
-            _currentGameModel->setReserveCards(stackCards);
+        // Play card move animation to the bottom position
+        animateCardMovement(selectedCard);
+        return true;
+    }
 
-            previousBottomCard->setLocation(undoModel->getPreviousBottomPosition());
-            previousBottomCard->setReversed(true);
-            _currentGameModel->setActiveCard(previousBottomCard);
+    /**
+     * Show a card moving to the bottom position
+     * @param movedCard Card that became the bottom card
+     */
+    void animateCardMovement(CardModel* movedCard)
+    {
+        _currentGameView->showCardMove(_currentGameModel, movedCard->getItemId());
+    }
 
-            // Update the view
-            _currentGameView->updateDisplay(_currentGameModel);
+    /**
+     * Draw a card from the stack and update the view
+     * @return True if a card was drawn
+     */
+    bool drawCardFromDeck()
+    {
+        MoveRecord move = MoveRecord::draw();
+        if (!_currentGameModel->applyMove(move)) {
+            return false;
         }
+        _historyManager->addUndoRecord(move);
+
+        // Play animation
+        animateCardMovement(_currentGameModel->getActiveCard());
+        return true;
     }
 
 private:
+    // Levels after the current one kept ready in LevelConfigCache
+    static const int kPrefetchLevelCount = 2;
+
+    // Time a hint search may take before it answers with what it has
+    static const int kHintBudgetMs = 50;
+
+    // Replay playback: one input per step at 1x, a little longer than a card move
+    static constexpr float kReplayStepSeconds = 0.6f;
+    static constexpr float kMinReplaySpeed = 1.0f;
+    static constexpr float kMaxReplaySpeed = 16.0f;
+    static constexpr const char* kReplayScheduleKey = "GameController.replay";
+
+    LevelConfigPtr _currentLevelConfig; // Shared with the cache, stays valid if the cache evicts it
     GameModel* _currentGameModel;
-    GameView* _currentGameView;
+    IGameView* _currentGameView;
+    GameView* _nodeGameView; // The view this controller created for the scene, if any
     UndoManager* _historyManager;
     GameModelFromLevelGenerator* _levelGenerator;
+    bool _headless;          // Playing against a view given by the caller
+    bool _wrapAround;        // Kings and aces also match each other
+    unsigned int _moveCount; // Matches, draws, undos and redos so far
+    std::shared_ptr<PendingHint> _pendingHint; // Latest hint request, until it is shown or cancelled
+    ReplayModel _replay;                       // Recording of the current session
+    ReplayCardIndex _replayCardIndex;          // Level indices of the current game's cards
+    std::vector<ReplayEvent> _replayEvents;    // Inputs of the replay being played back
+    size_t _replayCursor;                      // Next of them to play
+    bool _replaying;                           // Player input is ignored while true
 };
 
 #endif // GAME_CONTROLLER_H
@@ -0,0 +1,203 @@
+#pragma once
+#ifndef GAME_SAVE_MANAGER_H
+#define GAME_SAVE_MANAGER_H
+
+#include "cocos2d.h"
+#include "base/CCAsyncTaskPool.h"
+#include "UndoManager.h"
+#include "../models/GameModel.h"
+#include "../models/GameSnapshot.h"
+#include "../configs/models/LevelConfig.h"
+#include "../services/GameModelFromLevelGenerator.h"
+#include "../services/ReplaySimulator.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * 浵
+ * ѽеĶԾ֣ϷģͺͳʷΪƿգʱָ
+ * ߳ɣдļ AsyncTaskPool IO߳ɣдʱļ
+ * дһ˳Ҳ𻵵Ĵ浵IO̰߳ύ˳ִУύĴ浵̡
+ */
+class GameSaveManager
+{
+public:
+    static GameSaveManager& getInstance()
+    {
+        static GameSaveManager instance;
+        return instance;
+    }
+
+    /**
+     * ɿ
+     * @param gameModel Ϸģ
+     * @param history ʷ
+     * @param cardIndex ԾֿʼʱĿƹؿ
+     * @param levelId ؿID
+     * @param snapshot տ
+     * @return ƹ޷ʱfalse
+     */
+    static bool captureSnapshot(const GameModel& gameModel, const UndoManager& history, const ReplayCardIndex& cardIndex,
+        int levelId, GameSnapshot& snapshot)
+    {
+        if (cardIndex.getFieldCount() > GameSnapshot::kMaxFieldCards) {
+            CCLOG("GameSaveManager: Too many field cards to save: %d", cardIndex.getFieldCount());
+            return false;
+        }
+
+        snapshot.clear();
+        snapshot.setLevelId(levelId);
+        snapshot.setSeed(gameModel.getSeed());
+
+        snapshot.setCardCount(cardIndex.getCardCount(), cardIndex.getFieldCount());
+        for (int i = 0; i < cardIndex.getCardCount(); ++i) {
+            CardModel* card = gameModel.getCardById(cardIndex.getCardId(i));
+            snapshot.setFaceUp(i, card && card->isReversed());
+        }
+
+        for (size_t i = 0; i < history.getRecordCount(); ++i) {
+            const MoveRecord& move = history.getRecord(i);
+            if (move.getType() == ActionType::MATCH_CARD) {
+                snapshot.addMove(static_cast<uint8_t>(GameSnapshot::kMatchBase + cardIndex.getIndex(move.cardId)));
+            }
+            else {
+                snapshot.addMove(GameSnapshot::kDrawMove);
+            }
+        }
+        snapshot.setMoveCursor(static_cast<uint32_t>(history.getCursor()));
+        return true;
+    }
+
+    /**
+     * ӿջָԾ
+     * ؽؿطȫƶ󳷻ؿĲ֣ԭ״̬
+     * ÿƶҲĹ飬Уֻܷ𻵣ֲ˱ĹڵĴ浵
+     * @param snapshot 
+     * @param levelConfig ؿ
+     * @param history ճʷ
+     * @param cardIndex տƹؿ
+     * @param wrapAround KAǷҲڣ浵ʱĹһ
+     * @return Ϸģͣɵͷţؿ򺬷Ƿƶʱnullptr
+     */
+    static GameModel* restoreSnapshot(const GameSnapshot& snapshot, const LevelConfig& levelConfig,
+        UndoManager& history, ReplayCardIndex& cardIndex, bool wrapAround = false)
+    {
+        int cardCount = static_cast<int>(levelConfig.getMainAreaCards().size() + levelConfig.getBackupAreaCards().size());
+        if (snapshot.getFieldCount() != static_cast<int>(levelConfig.getMainAreaCards().size()) ||
+            snapshot.getCardCount() != cardCount) {
+            CCLOG("GameSaveManager: Save does not fit level %d", snapshot.getLevelId());
+            return nullptr;
+        }
+
+        GameModelFromLevelGenerator levelGenerator;
+        GameModel* gameModel = levelGenerator.createGameModelFromLevel(levelConfig);
+        gameModel->setSeed(snapshot.getSeed());
+        cardIndex.build(*gameModel);
+        history.setup();
+
+        const std::vector<uint8_t>& moves = snapshot.getMoves();
+        for (uint8_t code : moves) {
+            MoveRecord move = MoveRecord::draw();
+            if (code != GameSnapshot::kDrawMove) {
+                int fieldIndex = code - GameSnapshot::kMatchBase;
+                move = MoveRecord::match(fieldIndex < cardIndex.getFieldCount() ? cardIndex.getCardId(fieldIndex) : -1);
+            }
+            bool legal = move.getType() != ActionType::MATCH_CARD ||
+                ReplaySimulator::canMatch(*gameModel, move.cardId, wrapAround);
+            if (!legal || !gameModel->applyMove(move)) {
+                CCLOG("GameSaveManager: Save of level %d does not replay", snapshot.getLevelId());
+                history.reset();
+                delete gameModel;
+                return nullptr;
+            }
+            history.addUndoRecord(move);
+        }
+        for (size_t i = snapshot.getMoveCursor(); i < moves.size(); ++i) {
+            gameModel->revertMove(*history.popUndoRecord());
+        }
+
+        for (int i = 0; i < snapshot.getCardCount(); ++i) {
+            CardModel* card = gameModel->getCardById(cardIndex.getCardId(i));
+            if (card) {
+                card->setReversed(snapshot.isFaceUp(i));
+            }
+        }
+        return gameModel;
+    }
+
+    /**
+     * IO߳д浵
+     * @param snapshot գ÷غ󼴿޸
+     */
+    void saveAsync(const GameSnapshot& snapshot)
+    {
+        auto bytes = std::make_shared<std::vector<uint8_t>>();
+        snapshot.serialize(*bytes);
+
+        // · FileUtils߳
+        std::string path = getSavePath();
+        std::string tempPath = path + kTempSuffix;
+        cocos2d::AsyncTaskPool::getInstance()->enqueue(cocos2d::AsyncTaskPool::TaskType::TASK_IO,
+            [bytes, path, tempPath]() {
+                cocos2d::Data data;
+                data.copy(bytes->data(), static_cast<ssize_t>(bytes->size()));
+                cocos2d::FileUtils* fileUtils = cocos2d::FileUtils::getInstance();
+                if (!fileUtils->writeDataToFile(data, tempPath) || !fileUtils->renameFile(tempPath, path)) {
+                    CCLOG("GameSaveManager: Failed to write %s", path.c_str());
+                }
+            });
+    }
+
+    /**
+     * ȡ浵
+     * @param snapshot տ
+     * @return ûд浵浵ʱfalse
+     */
+    bool loadSnapshot(GameSnapshot& snapshot) const
+    {
+        cocos2d::FileUtils* fileUtils = cocos2d::FileUtils::getInstance();
+        std::string path = getSavePath();
+        if (!fileUtils->isFileExist(path)) {
+            return false;
+        }
+        cocos2d::Data data = fileUtils->getDataFromFile(path);
+        if (data.isNull() || !snapshot.deserialize(data.getBytes(), static_cast<size_t>(data.getSize()))) {
+            CCLOG("GameSaveManager: Ignoring damaged save %s", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * ɾ浵ؿɺύдִ֮
+     */
+    void removeSave()
+    {
+        std::string path = getSavePath();
+        cocos2d::AsyncTaskPool::getInstance()->enqueue(cocos2d::AsyncTaskPool::TaskType::TASK_IO,
+            [path]() {
+                cocos2d::FileUtils* fileUtils = cocos2d::FileUtils::getInstance();
+                if (fileUtils->isFileExist(path)) {
+                    fileUtils->removeFile(path);
+                }
+            });
+    }
+
+    // 浵ļ·
+    std::string getSavePath() const
+    {
+        return cocos2d::FileUtils::getInstance()->getWritablePath() + kSaveFileName;
+    }
+
+private:
+    GameSaveManager() {}
+
+    GameSaveManager(const GameSaveManager&) = delete;
+    GameSaveManager& operator=(const GameSaveManager&) = delete;
+
+    static constexpr const char* kSaveFileName = "savegame.bin"; // 浵ļ
+    static constexpr const char* kTempSuffix = ".tmp";           // деʱļ׺
+};
+
+#endif // GAME_SAVE_MANAGER_H
@@ -0,0 +1,222 @@
+#pragma once
+#ifndef LEVEL_CONFIG_CACHE_H
+#define LEVEL_CONFIG_CACHE_H
+
+#include "cocos2d.h"
+#include "base/CCAsyncTaskPool.h"
+#include "../configs/models/LevelConfig.h"
+#include "../configs/loaders/LevelConfigLoader.h"
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// еĹؿô޸ģڶߺ̼߳乲
+typedef std::shared_ptr<const LevelConfig> LevelConfigPtr;
+
+/**
+ * ؿû
+ * ؿIDֻĹؿãʱ̭δʹõĹؿ
+ * prefetch  AsyncTaskPool IO߳Ԥȼغؿ
+ * ʼؿʱֱл棬߳̽ļ
+ *  prefetch ĺ̨⣬з̵߳á
+ */
+class LevelConfigCache
+{
+public:
+    static LevelConfigCache& getInstance()
+    {
+        static LevelConfigCache instance;
+        return instance;
+    }
+
+    /**
+     * ûؿ̭
+     * @param capacity Ϊ1
+     */
+    void setCapacity(size_t capacity)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _capacity = std::max<size_t>(capacity, 1);
+        evictLocked();
+    }
+
+    size_t getCapacity() const { return _capacity; }
+
+    /**
+     * ȡؿ
+     * ʱֱӷأڵǰ߳ͬءؿԤȡʱҲȴ
+     * ̨ܻԤȡ̵֮߳ȴԼظ
+     * @param levelId ؿID
+     * @return ؿãؿڻʧʱnullptr
+     */
+    LevelConfigPtr getLevelConfig(int levelId)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            LevelConfigPtr config = findLocked(levelId);
+            if (config) {
+                _hitCount++;
+                return config;
+            }
+            _missCount++;
+            _loading[levelId]++;
+        }
+
+        LevelRequest request = createRequest(levelId);
+        LevelConfigPtr config = loadLevel(request);
+        finishLoading(levelId, config);
+        return config;
+    }
+
+    /**
+     * ֻѯأһԤȲܵȴĳ
+     * @param levelId ؿID
+     * @return ѻĹؿãδʱnullptr
+     */
+    LevelConfigPtr peekLevelConfig(int levelId)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return findLocked(levelId);
+    }
+
+    /**
+     * ں̨Ԥȡؿ firstLevelId .. firstLevelId + count - 1
+     * ѻڼصĹؿᱻ
+     * @param firstLevelId һؿID
+     * @param count ؿĲֻᱻ
+     */
+    void prefetch(int firstLevelId, int count)
+    {
+        int limit = std::min<int>(count, static_cast<int>(_capacity));
+        for (int i = 0; i < limit; ++i) {
+            int levelId = firstLevelId + i;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_entries.count(levelId) || _loading.count(levelId)) {
+                    continue;
+                }
+                _loading[levelId]++;
+            }
+
+            // · FileUtils 棬߳ɣֻ̨ȡļ
+            LevelRequest request = createRequest(levelId);
+            cocos2d::AsyncTaskPool::getInstance()->enqueue(cocos2d::AsyncTaskPool::TaskType::TASK_IO,
+                [this, request]() {
+                    finishLoading(request.levelId, loadLevel(request));
+                });
+        }
+    }
+
+    /**
+     * ջ棬ڽеԤȡɺԻд
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _entries.clear();
+        _recentLevels.clear();
+    }
+
+    // δдͳƻЧ̶߳ȡ
+    int getHitCount() const { return _hitCount.load(); }
+    int getMissCount() const { return _missCount.load(); }
+
+    LevelConfigCache(const LevelConfigCache&) = delete;
+    LevelConfigCache& operator=(const LevelConfigCache&) = delete;
+
+private:
+    LevelConfigCache() : _capacity(8), _hitCount(0), _missCount(0) {}
+
+    // һؿϢ߳׼
+    struct LevelRequest
+    {
+        int levelId;
+        bool inLevelPack;      // ؿڶƹؿ
+        std::string fullPath;  // ΪJSONļ·
+    };
+
+    struct CacheEntry
+    {
+        LevelConfigPtr config;
+        std::list<int>::iterator recentPosition; //  _recentLevels еλ
+    };
+
+    static LevelRequest createRequest(int levelId)
+    {
+        LevelRequest request;
+        request.levelId = levelId;
+        request.inLevelPack = LevelConfigLoader::getLevelPack().hasLevel(levelId);
+        if (!request.inLevelPack) {
+            request.fullPath = LevelConfigLoader::getLevelFilePath(levelId);
+        }
+        return request;
+    }
+
+    // ִ߳
+    static LevelConfigPtr loadLevel(const LevelRequest& request)
+    {
+        std::shared_ptr<LevelConfig> config = std::make_shared<LevelConfig>();
+        bool loaded = request.inLevelPack
+            ? LevelConfigLoader::getLevelPack().loadLevelConfig(request.levelId, *config)
+            : (!request.fullPath.empty() && LevelConfigLoader::loadLevelConfigFromFile(request.fullPath, *config));
+        if (!loaded) {
+            CCLOG("LevelConfigCache: failed to load level %d", request.levelId);
+            return nullptr;
+        }
+        return config;
+    }
+
+    // ͬһؿԤȡͬؿͬʱУɵд뻺棬ɵ滻Ϊͬ
+    void finishLoading(int levelId, const LevelConfigPtr& config)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto loading = _loading.find(levelId);
+        if (loading != _loading.end() && --loading->second == 0) {
+            _loading.erase(loading);
+        }
+        if (config) {
+            auto it = _entries.find(levelId);
+            if (it != _entries.end()) {
+                _recentLevels.erase(it->second.recentPosition);
+            }
+            _recentLevels.push_front(levelId);
+            CacheEntry& entry = _entries[levelId];
+            entry.config = config;
+            entry.recentPosition = _recentLevels.begin();
+            evictLocked();
+        }
+    }
+
+    // ҲΪʹã÷ _mutex
+    LevelConfigPtr findLocked(int levelId)
+    {
+        auto it = _entries.find(levelId);
+        if (it == _entries.end()) {
+            return nullptr;
+        }
+        _recentLevels.splice(_recentLevels.begin(), _recentLevels, it->second.recentPosition);
+        return it->second.config;
+    }
+
+    // ̭δʹõĹؿ÷ _mutex
+    void evictLocked()
+    {
+        while (_entries.size() > _capacity) {
+            _entries.erase(_recentLevels.back());
+            _recentLevels.pop_back();
+        }
+    }
+
+    std::mutex _mutex;
+    size_t _capacity;
+    std::unordered_map<int, CacheEntry> _entries;
+    std::list<int> _recentLevels;          // ʹõĹؿǰ
+    std::unordered_map<int, int> _loading; // ڼصĹؿеļ
+    std::atomic<int> _hitCount;
+    std::atomic<int> _missCount;
+};
+
+#endif // LEVEL_CONFIG_CACHE_H
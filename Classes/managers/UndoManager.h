@@ -2,17 +2,18 @@
 #ifndef UNDO_MANAGER_H
 #define UNDO_MANAGER_H
 
-#include "../models/UndoModel.h"
+#include "../models/GameModel.h"
 #include <vector>
 
 /**
  * 
- * ܣʷ¼
+ * 鱣ÿ MoveRecord8ֽڣα֮ǰļ¼ɳ֮Ŀ
+ * ʷ¼ޣ500Լռ 4KB
  */
 class UndoManager
 {
 public:
-    UndoManager() {}
+    UndoManager() : _cursor(0) {}
     ~UndoManager()
     {
         reset();
@@ -20,66 +21,96 @@ public:
 
     /**
      * ʼ
+     * Ԥʷÿʱ
      */
     void setup()
     {
         reset();
+        _history.reserve(kReservedHistorySize);
     }
 
     /**
-     * ӳ¼
-     * @param record ģ
+     * Ӳ¼
+     * ²ᶪδļ¼
+     * @param record ִеĲ¼
      */
-    void addUndoRecord(UndoModel* record)
+    void addUndoRecord(const MoveRecord& record)
     {
-        if (record) {
-            _history.push_back(record);
-            CCLOG("UndoManager: Added undo record, history size: %d", _history.size());
-        }
+        _history.resize(_cursor);
+        _history.push_back(record);
+        _cursor = _history.size();
     }
 
     /**
-     * Ƴĳ¼
-     * @return ģͣûм¼nullptr
+     * һ
+     * @return ҪĲ¼ûм¼nullptr¼һǰЧ
      */
-    UndoModel* removeUndoRecord()
+    const MoveRecord* popUndoRecord()
     {
-        if (_history.empty()) {
+        if (_cursor == 0) {
             CCLOG("UndoManager: No records to undo");
             return nullptr;
         }
+        return &_history[--_cursor];
+    }
 
-        UndoModel* record = _history.back();
-        _history.pop_back();
-        CCLOG("UndoManager: Removed undo record, history size: %d", _history.size());
-        return record;
+    /**
+     * ǰһ
+     * @return ҪĲ¼ûм¼nullptr¼һǰЧ
+     */
+    const MoveRecord* popRedoRecord()
+    {
+        if (_cursor == _history.size()) {
+            CCLOG("UndoManager: No records to redo");
+            return nullptr;
+        }
+        return &_history[_cursor++];
     }
 
+    /**
+     * ʧʱ˻αּ꣬¼Ϸ״̬һ
+     */
+    void cancelUndo() { _cursor++; }
+    void cancelRedo() { _cursor--; }
+
     /**
      * ǷпɳĲ
      * @return ǷпɳĲ
      */
-    bool hasUndoableActions() const
-    {
-        bool result = !_history.empty();
-        CCLOG("UndoManager: hasUndoableActions=%d, history size=%d", result, _history.size());
-        return result;
-    }
+    bool hasUndoableActions() const { return _cursor > 0; }
+
+    /**
+     * ǷпĲ
+     * @return ǷпĲ
+     */
+    bool hasRedoableActions() const { return _cursor < _history.size(); }
+
+    // ¼ļ¼
+    size_t getRecordCount() const { return _history.size(); }
+
+    // ˳ʼ¼ڴ浵
+    const MoveRecord& getRecord(size_t index) const { return _history[index]; }
+
+    // ִеļ¼֮ļ¼
+    size_t getCursor() const { return _cursor; }
+
+    // ʷ¼ռõֽ
+    size_t getMemoryUsage() const { return _history.capacity() * sizeof(MoveRecord); }
 
     /**
-     * г¼
+     * в¼
      */
     void reset()
     {
-        for (std::vector<UndoModel*>::iterator it = _history.begin(); it != _history.end(); ++it) {
-            delete* it;
-        }
         _history.clear();
-        CCLOG("UndoManager: All undo records cleared");
+        _cursor = 0;
     }
 
 private:
-    std::vector<UndoModel*> _history; // ʷ¼
+    static const size_t kReservedHistorySize = 256; // Ԥʷ¼
+
+    std::vector<MoveRecord> _history; // ʷ¼
+    size_t _cursor;                   // ִеļ¼֮ļ¼
 };
 
 #endif // UNDO_MANAGER_H
@@ -104,11 +104,26 @@ class CardModel
 {
 public:
     CardModel()
-        : _suit(CardSuitType::CST_NONE), _face(CardFaceType::CFT_NONE), _itemId(0), _status(new UnreversedStatus())
+        : _suit(CardSuitType::CST_NONE), _face(CardFaceType::CFT_NONE), _itemId(0), _status(new UnreversedStatus()),
+          _ownsStatus(true)
     {
     }
 
-    ~CardModel() { delete _status; }
+    // ʹⲿ״̬ GameArena зģƲͷ
+    explicit CardModel(ICardStatus* status)
+        : _suit(CardSuitType::CST_NONE), _face(CardFaceType::CFT_NONE), _itemId(0), _status(status),
+          _ownsStatus(false)
+    {
+    }
+
+    ~CardModel()
+    {
+        if (_ownsStatus)
+            delete _status;
+    }
+
+    CardModel(const CardModel&) = delete;
+    CardModel& operator=(const CardModel&) = delete;
 
     // ȡÿƻɫ
     CardSuitType getSuitType() const { return _suit; }
@@ -147,6 +162,7 @@ private:
     CardFaceType _face;        // ֵ
     int _itemId;           // ΨһID
     ICardStatus* _status;  // ǰ״̬תδת
+    bool _ownsStatus;      // ״̬Ƿɿͷ
 };
 
 #endif // DECK_ITEM_H
@@ -0,0 +1,462 @@
+#pragma once
+#ifndef COMPACT_GAME_STATE_H
+#define COMPACT_GAME_STATE_H
+
+#include "cocos2d.h"
+#include "CardModel.h"
+#include "GameModel.h"
+#include "../utils/GameUtils.h"
+#include <algorithm>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * Zobrist keys shared by every compact state
+ * Field membership and the active card are XOR keys; the reserve is hashed
+ * as a polynomial over per-card keys so its order is part of the hash and
+ * both ring operations stay O(1).
+ */
+class CompactZobristKeys
+{
+public:
+    static const int kSlots = 64;
+
+    static const CompactZobristKeys& getInstance()
+    {
+        static CompactZobristKeys instance;
+        return instance;
+    }
+
+    uint64_t fieldKeys[kSlots];     // Card slot is on the field
+    uint64_t activeKeys[kSlots];    // Card slot is the active card
+    uint64_t reserveKeys[kSlots];   // Card slot term of the reserve polynomial
+    uint64_t reservePowers[kSlots + 1]; // kReserveMultiplier^k
+
+    static const uint64_t kReserveMultiplier = 0x9E3779B97F4A7C15ULL;
+
+private:
+    CompactZobristKeys()
+    {
+        uint64_t seed = 0x2545F4914F6CDD1DULL;
+        for (int i = 0; i < kSlots; ++i) {
+            fieldKeys[i] = nextKey(seed);
+            activeKeys[i] = nextKey(seed);
+            reserveKeys[i] = nextKey(seed);
+        }
+        reservePowers[0] = 1;
+        for (int i = 1; i <= kSlots; ++i) {
+            reservePowers[i] = reservePowers[i - 1] * kReserveMultiplier;
+        }
+    }
+
+    // splitmix64
+    static uint64_t nextKey(uint64_t& seed)
+    {
+        uint64_t value = (seed += 0x9E3779B97F4A7C15ULL);
+        value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+        return value ^ (value >> 31);
+    }
+};
+
+/**
+ * Immutable per-level card data for compact states
+ * Cards are addressed by slot (0-63) rather than by deck position, because
+ * a level may repeat a face/suit. Face and suit are packed in one byte.
+ */
+class CompactCardTable
+{
+public:
+    static const int kMaxCards = 64;
+
+    CompactCardTable() : _cardCount(0), _fieldSlotCount(0), _hasOcclusion(false)
+    {
+        std::memset(_packedCards, 0, sizeof(_packedCards));
+        std::memset(_rankMasks, 0, sizeof(_rankMasks));
+        std::memset(_aboveMasks, 0, sizeof(_aboveMasks));
+        std::memset(_belowMasks, 0, sizeof(_belowMasks));
+    }
+
+    /**
+     * Append a card
+     * @param face Face, CFT_ACE ... CFT_KING
+     * @param suit Suit, CST_CLUBS ... CST_SPADES
+     * @param location Level location of a card dealt to the field, else the card's location
+     * @param layer Level (draw) order of a card dealt to the field, -1 for the others
+     * @return Slot of the new card
+     */
+    uint8_t addCard(CardFaceType face, CardSuitType suit, int cardId, const cocos2d::Vec2& location, int layer = -1)
+    {
+        uint8_t slot = static_cast<uint8_t>(_cardCount++);
+        _packedCards[slot] = static_cast<uint8_t>((face & 0x0F) | ((suit & 0x0F) << 4));
+        _cardIds[slot] = cardId;
+        _locations[slot] = location;
+        _layers[slot] = static_cast<int8_t>(layer);
+        if (face >= 0 && face < CFT_NUM_CARD_FACE_TYPES) {
+            _rankMasks[face] |= 1ULL << slot;
+        }
+        return slot;
+    }
+
+    int getCardCount() const { return _cardCount; }
+
+    // Slots below this count started on the field
+    int getFieldSlotCount() const { return _fieldSlotCount; }
+    void setFieldSlotCount(int count) { _fieldSlotCount = count; }
+
+    CardFaceType getFaceType(int slot) const { return static_cast<CardFaceType>(_packedCards[slot] & 0x0F); }
+    CardSuitType getSuitType(int slot) const { return static_cast<CardSuitType>(_packedCards[slot] >> 4); }
+
+    // Card value, A=1 ... K=13
+    int getCardValue(int slot) const { return (_packedCards[slot] & 0x0F) + 1; }
+
+    int getCardId(int slot) const { return _cardIds[slot]; }
+    const cocos2d::Vec2& getLocation(int slot) const { return _locations[slot]; }
+
+    // Level (draw) order of a card dealt to the field, also once it has left; -1 for the others
+    int getLayer(int slot) const { return _layers[slot]; }
+
+    /**
+     * Slots holding a face
+     * @param face Face index (CFT_ACE ... CFT_KING)
+     */
+    uint64_t getFaceMask(int face) const { return _rankMasks[face]; }
+
+    /**
+     * Record that one field card lies on top of another
+     * @param upperSlot The covering card
+     * @param lowerSlot The covered card
+     */
+    void addOcclusion(int upperSlot, int lowerSlot)
+    {
+        _aboveMasks[lowerSlot] |= 1ULL << upperSlot;
+        _belowMasks[upperSlot] |= 1ULL << lowerSlot;
+        _hasOcclusion = true;
+    }
+
+    // Slots lying on top of a slot / under a slot
+    uint64_t getAboveMask(int slot) const { return _aboveMasks[slot]; }
+    uint64_t getBelowMask(int slot) const { return _belowMasks[slot]; }
+
+    /**
+     * Keep the slots nothing on the field lies on top of
+     * @param slots Candidate field slots
+     * @param fieldMask Slots on the field
+     */
+    uint64_t filterPlayable(uint64_t slots, uint64_t fieldMask) const
+    {
+        if (!_hasOcclusion) {
+            return slots;
+        }
+        uint64_t playable = 0;
+        for (uint64_t bits = slots; bits; bits &= bits - 1) {
+            int slot = GameUtils::lowestBitIndex(bits);
+            if (!(_aboveMasks[slot] & fieldMask)) {
+                playable |= 1ULL << slot;
+            }
+        }
+        return playable;
+    }
+
+    /**
+     * Find the slot of a card id
+     * @return Slot, or -1 if the id is unknown
+     */
+    int findSlot(int cardId) const
+    {
+        for (int slot = 0; slot < _cardCount; ++slot) {
+            if (_cardIds[slot] == cardId) {
+                return slot;
+            }
+        }
+        return -1;
+    }
+
+private:
+    uint8_t _packedCards[kMaxCards];          // Face in the low nibble, suit in the high nibble
+    int _cardIds[kMaxCards];                  // CardModel ids
+    cocos2d::Vec2 _locations[kMaxCards];      // Level locations of cards dealt to the field, else CardModel locations
+    int8_t _layers[kMaxCards];                // Level order of cards dealt to the field, -1 for the others
+    uint64_t _rankMasks[CFT_NUM_CARD_FACE_TYPES]; // Slots per face
+    uint64_t _aboveMasks[kMaxCards];          // Field slots covering each slot
+    uint64_t _belowMasks[kMaxCards];          // Field slots each slot covers
+    int _cardCount;
+    int _fieldSlotCount;
+    bool _hasOcclusion;
+};
+
+/**
+ * Compact game state for simulation
+ * A trivially copyable value type: field and reserve membership are slot
+ * bitmasks, the reserve is a fixed-size ring in GameModel order (front is
+ * index 0, back is drawn next) and the Zobrist hash is kept incrementally.
+ * Card data lives in a CompactCardTable shared by all states of a level.
+ */
+struct CompactGameState
+{
+    static const int kRingSize = 64;
+    static const uint8_t kNoCard = 0xFF;
+
+    uint64_t fieldMask;    // Slots on the field
+    uint64_t reserveMask;  // Slots in the reserve
+    uint64_t faceUpMask;   // Slots whose CardModel is reversed (face up)
+    uint64_t fieldHash;    // Zobrist keys of the field and the active card
+    uint64_t reserveHash;  // Ordered hash of the reserve
+    uint8_t reserve[kRingSize];
+    uint8_t reserveHead;   // Ring index of the reserve front
+    uint8_t reserveCount;
+    uint8_t activeCard;    // Slot of the active card, or kNoCard
+
+    /**
+     * Reset to an empty board
+     */
+    void clear()
+    {
+        std::memset(this, 0, sizeof(*this));
+        activeCard = kNoCard;
+    }
+
+    uint64_t getHash() const { return fieldHash ^ reserveHash; }
+
+    bool isFieldCleared() const { return fieldMask == 0; }
+
+    /**
+     * Reserve card by position, 0 is the front
+     */
+    uint8_t getReserveCard(int index) const { return reserve[(reserveHead + index) & (kRingSize - 1)]; }
+
+    // Next card to be drawn
+    uint8_t getReserveTop() const { return getReserveCard(reserveCount - 1); }
+
+    void addFieldCard(uint8_t slot)
+    {
+        fieldMask |= 1ULL << slot;
+        fieldHash ^= CompactZobristKeys::getInstance().fieldKeys[slot];
+    }
+
+    void setActiveCard(uint8_t slot)
+    {
+        const CompactZobristKeys& keys = CompactZobristKeys::getInstance();
+        if (activeCard != kNoCard) {
+            fieldHash ^= keys.activeKeys[activeCard];
+        }
+        activeCard = slot;
+        if (slot != kNoCard) {
+            fieldHash ^= keys.activeKeys[slot];
+            faceUpMask |= 1ULL << slot;
+        }
+    }
+
+    void pushReserveFront(uint8_t slot)
+    {
+        reserveHead = static_cast<uint8_t>((reserveHead - 1) & (kRingSize - 1));
+        reserve[reserveHead] = slot;
+        reserveCount++;
+        reserveMask |= 1ULL << slot;
+        reserveHash = CompactZobristKeys::getInstance().reserveKeys[slot] + CompactZobristKeys::kReserveMultiplier * reserveHash;
+    }
+
+    void pushReserveBack(uint8_t slot)
+    {
+        reserve[(reserveHead + reserveCount) & (kRingSize - 1)] = slot;
+        const CompactZobristKeys& keys = CompactZobristKeys::getInstance();
+        reserveHash += keys.reserveKeys[slot] * keys.reservePowers[reserveCount];
+        reserveCount++;
+        reserveMask |= 1ULL << slot;
+    }
+
+    uint8_t popReserveBack()
+    {
+        uint8_t slot = getReserveTop();
+        reserveCount--;
+        reserveMask &= ~(1ULL << slot);
+        const CompactZobristKeys& keys = CompactZobristKeys::getInstance();
+        reserveHash -= keys.reserveKeys[slot] * keys.reservePowers[reserveCount];
+        return slot;
+    }
+
+    /**
+     * Match a field card onto the active card, as GameModel::applyMove does
+     * The caller checks that the cards are adjacent.
+     */
+    void applyMatch(uint8_t slot)
+    {
+        fieldMask &= ~(1ULL << slot);
+        fieldHash ^= CompactZobristKeys::getInstance().fieldKeys[slot];
+        if (activeCard != kNoCard) {
+            pushReserveFront(activeCard);
+        }
+        setActiveCard(slot);
+    }
+
+    /**
+     * Draw the reserve top onto the active position, as GameModel::applyMove does
+     * The caller checks that the reserve is not empty.
+     */
+    void applyDraw()
+    {
+        uint8_t drawnCard = popReserveBack();
+        if (activeCard != kNoCard) {
+            pushReserveFront(activeCard);
+        }
+        setActiveCard(drawnCard);
+    }
+
+    /**
+     * Convert a game model
+     * @param gameModel Source model, left unchanged
+     * @param table Receives the card data
+     * @param state Receives the state
+     * @return False if the model holds more than 64 cards, or a card without
+     *         a real face and suit, which the 4-bit fields cannot tell apart
+     *         from a real card
+     */
+    static bool fromGameModel(const GameModel& gameModel, CompactCardTable& table, CompactGameState& state)
+    {
+        const std::vector<CardModel*>& fieldCards = gameModel.getFieldCards();
+        const std::vector<CardModel*>& reserveCards = gameModel.getReserveCards();
+        CardModel* activeCard = gameModel.getActiveCard();
+
+        size_t totalCards = fieldCards.size() + reserveCards.size() + (activeCard ? 1 : 0);
+        if (totalCards > static_cast<size_t>(CompactCardTable::kMaxCards)) {
+            return false;
+        }
+        if (activeCard && !isPackable(activeCard)) {
+            return false;
+        }
+        for (auto card : fieldCards) {
+            if (!isPackable(card)) {
+                return false;
+            }
+        }
+        for (auto card : reserveCards) {
+            if (!isPackable(card)) {
+                return false;
+            }
+        }
+
+        table = CompactCardTable();
+        state.clear();
+
+        const OcclusionGraph& occlusionGraph = gameModel.getOcclusionGraph();
+        for (auto card : fieldCards) {
+            uint8_t slot = addCard(table, state, occlusionGraph, card);
+            state.addFieldCard(slot);
+        }
+        table.setFieldSlotCount(table.getCardCount());
+
+        // Overlaps between the cards still on the field
+        for (int lowerSlot = 0; lowerSlot < table.getFieldSlotCount(); ++lowerSlot) {
+            occlusionGraph.forEachCardAbove(table.getCardId(lowerSlot), [&table, lowerSlot](int upperCardId) {
+                int upperSlot = table.findSlot(upperCardId);
+                if (upperSlot >= 0 && upperSlot < table.getFieldSlotCount()) {
+                    table.addOcclusion(upperSlot, lowerSlot);
+                }
+            });
+        }
+
+        for (auto card : reserveCards) {
+            state.pushReserveBack(addCard(table, state, occlusionGraph, card));
+        }
+
+        if (activeCard) {
+            bool reversed = activeCard->isReversed();
+            state.setActiveCard(addCard(table, state, occlusionGraph, activeCard));
+            if (!reversed) {
+                state.faceUpMask &= ~(1ULL << state.activeCard);
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Build a new game model from a state
+     * Ids, faces, suits, locations and reversed flags come back unchanged.
+     * The occlusion graph is rebuilt from every card the level dealt to the
+     * field, in level order, so cards keep their layers and cover counts
+     * even when the source's field cards were out of order; field cards
+     * that have left the field sit at the bottom card node, as
+     * GameController leaves them.
+     * @return New game model owned by the caller
+     */
+    static GameModel* toGameModel(const CompactCardTable& table, const CompactGameState& state)
+    {
+        GameModel* gameModel = new GameModel();
+
+        std::vector<CardModel*> cards(table.getCardCount());
+        std::vector<int> layoutSlots;
+        for (int slot = 0; slot < table.getCardCount(); ++slot) {
+            cards[slot] = createCard(*gameModel, table, slot);
+            if (table.getLayer(slot) >= 0) {
+                layoutSlots.push_back(slot);
+            }
+        }
+        std::sort(layoutSlots.begin(), layoutSlots.end(), [&table](int a, int b) {
+            return table.getLayer(a) < table.getLayer(b);
+        });
+
+        std::vector<CardModel*> layoutCards;
+        std::vector<CardModel*> fieldCards;
+        for (int slot : layoutSlots) {
+            layoutCards.push_back(cards[slot]);
+            if (state.fieldMask & (1ULL << slot)) {
+                fieldCards.push_back(cards[slot]);
+            }
+        }
+        gameModel->setFieldLayout(layoutCards, fieldCards);
+
+        std::vector<CardModel*> reserveCards;
+        for (int i = 0; i < state.reserveCount; ++i) {
+            reserveCards.push_back(cards[state.getReserveCard(i)]);
+        }
+        gameModel->setReserveCards(reserveCards);
+
+        if (state.activeCard != kNoCard) {
+            gameModel->setActiveCard(cards[state.activeCard]);
+        }
+
+        // The layout turns field cards by cover, the state keeps the flags as they were
+        for (int slot = 0; slot < table.getCardCount(); ++slot) {
+            cards[slot]->setReversed((state.faceUpMask & (1ULL << slot)) != 0);
+        }
+        return gameModel;
+    }
+
+private:
+    // Only real cards are packed, CFT_NONE/CST_NONE would become face and suit 15
+    static bool isPackable(const CardModel* card)
+    {
+        return card->getFaceType() >= CFT_ACE && card->getFaceType() < CFT_NUM_CARD_FACE_TYPES &&
+            card->getSuitType() >= CST_CLUBS && card->getSuitType() < CST_NUM_CARD_SUIT_TYPES;
+    }
+
+    // Cards the level dealt to the field keep their layer and level location, also once they have left it
+    static uint8_t addCard(CompactCardTable& table, CompactGameState& state, const OcclusionGraph& occlusionGraph,
+        const CardModel* card)
+    {
+        int layer = occlusionGraph.getLayer(card->getItemId());
+        cocos2d::Vec2 location = layer >= 0 ? occlusionGraph.getLocation(card->getItemId()) : card->getLocation();
+        uint8_t slot = table.addCard(card->getFaceType(), card->getSuitType(), card->getItemId(), location, layer);
+        if (card->isReversed()) {
+            state.faceUpMask |= 1ULL << slot;
+        }
+        return slot;
+    }
+
+    static CardModel* createCard(GameModel& gameModel, const CompactCardTable& table, int slot)
+    {
+        CardModel* card = gameModel.createCard();
+        card->setItemId(table.getCardId(slot));
+        card->setFaceType(table.getFaceType(slot));
+        card->setSuitType(table.getSuitType(slot));
+        card->setLocation(table.getLocation(slot));
+        return card;
+    }
+};
+
+static_assert(sizeof(CompactGameState) <= 128, "CompactGameState must stay a small memcpy");
+static_assert(std::is_trivially_copyable<CompactGameState>::value, "CompactGameState must be trivially copyable");
+
+#endif // COMPACT_GAME_STATE_H
@@ -4,120 +4,159 @@
 
 #include "cocos2d.h"
 #include "CardModel.h"
+#include "OcclusionGraph.h"
+#include "../utils/GameArena.h"
+#include "../utils/GameRandom.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
 #include <vector>
-#include <unordered_map>
 #include <unordered_set>
 
 // Forward declaration
 class CardModel;
 
-// Card Action Interface
-class CardAction {
-public:
-    virtual ~CardAction() {}
-    virtual void performAction(std::vector<CardModel*>& fieldCards, std::vector<CardModel*>& reserveCards, CardModel* activeCard, std::unordered_map<int, CardModel*>& cardDictionary) = 0;
-};
+/**
+ * One player move, as kept in the move log
+ * A plain 8-byte record: the cards a move touches follow from its card and
+ * the reserve order, so GameModel can apply and revert it without
+ * snapshotting anything else.
+ */
+struct MoveRecord
+{
+    enum Flags : uint8_t
+    {
+        kHadActiveCard = 0x01, // An active card was replaced and went under the reserve
+        kWasFaceUp = 0x02      // The moved card was face up before the move
+    };
 
-// Action Class: Remove Card
-class RemoveCardAction : public CardAction {
-public:
-    RemoveCardAction(int cardId) : _cardId(cardId) {}
-
-    void performAction(std::vector<CardModel*>& fieldCards, std::vector<CardModel*>& reserveCards, CardModel* activeCard, std::unordered_map<int, CardModel*>& cardDictionary) override {
-        for (auto it = fieldCards.begin(); it != fieldCards.end(); ++it) {
-            if ((*it)->getItemId() == _cardId) {
-                fieldCards.erase(it);
-                cardDictionary.erase(_cardId);
-                break;
-            }
-        }
+    // Match a field card onto the active card
+    static MoveRecord match(int cardId)
+    {
+        MoveRecord move = MoveRecord();
+        move.cardId = cardId;
+        move.type = static_cast<uint8_t>(ActionType::MATCH_CARD);
+        return move;
     }
 
-private:
-    int _cardId;
-};
-
-// Action Class: Draw Card
-class DrawCardAction : public CardAction {
-public:
-    DrawCardAction() {}
-
-    void performAction(std::vector<CardModel*>& fieldCards, std::vector<CardModel*>& reserveCards, CardModel* activeCard, std::unordered_map<int, CardModel*>& cardDictionary) override {
-        if (reserveCards.empty()) {
-            CCLOG("GameModel: No more cards in the reserve stack");
-            return;
-        }
-        CardModel* drawnCard = reserveCards.back();
-        reserveCards.pop_back();
-        cardDictionary.erase(drawnCard->getItemId());
-
-        // Store the drawn card for future reference
-        _drawnCard = drawnCard;
+    // Draw the reserve top; applying the move fills in the card
+    static MoveRecord draw()
+    {
+        MoveRecord move = MoveRecord();
+        move.cardId = -1;
+        move.type = static_cast<uint8_t>(ActionType::DRAW_CARD);
+        return move;
     }
 
-    // Retrieve the drawn card
-    CardModel* getDrawnCard() const { return _drawnCard; }
+    ActionType getType() const { return static_cast<ActionType>(type); }
 
-private:
-    CardModel* _drawnCard = nullptr;  // Store the drawn card
+    int32_t cardId;      // Matched field card, or the card drawn from the reserve
+    uint16_t fieldIndex; // Where the matched card sat in the field cards
+    uint8_t type;        // ActionType
+    uint8_t flags;       // Flags
 };
 
-// Action Class: Add Card to Active Position
-class AddCardToActivePositionAction : public CardAction {
-public:
-    AddCardToActivePositionAction(CardModel* card) : _card(card) {}
-
-    void performAction(std::vector<CardModel*>& fieldCards, std::vector<CardModel*>& reserveCards, CardModel* activeCard, std::unordered_map<int, CardModel*>& cardDictionary) override {
-        if (activeCard) {
-            reserveCards.insert(reserveCards.begin(), activeCard);
-        }
-        activeCard = _card;
-        if (_card) {
-            cardDictionary[_card->getItemId()] = _card;
-        }
-    }
-
-private:
-    CardModel* _card;
-};
+static_assert(sizeof(MoveRecord) == 8, "MoveRecord should stay 8 bytes");
+static_assert(std::is_trivially_copyable<MoveRecord>::value, "MoveRecord should stay a plain record");
 
 /**
  * Game State Model
- * Responsible for storing and managing the game's current state and data
+ * Responsible for storing and managing the game's current state and data.
+ * Cards and card statuses of one game live in its arena and are all
+ * released together with the model. Card IDs are dense within a game
+ * (0 to N-1, in creation order), so looking a card up is an array index.
+ *
+ * Once a game is set up, cards only change places through applyMove() and
+ * revertMove(), which touch the moved cards and nothing else.
  */
 class GameModel
 {
 public:
-    GameModel() : _activeCard(nullptr), _currentAction(nullptr) {}
-    ~GameModel()
+    GameModel() : _activeCard(nullptr), _nextCardId(0), _seed(0) {}
+
+    GameModel(const GameModel&) = delete;
+    GameModel& operator=(const GameModel&) = delete;
+
+    /**
+     * Create a card owned by this game
+     * Cards get the next free ID of the game, so cards created in level
+     * order have their level index as ID, the same in every run.
+     * @return New face-down card at (0, 0)
+     */
+    CardModel* createCard()
     {
-        // Cleanup all card objects
-        for (auto card : _fieldCards) {
-            delete card;
-        }
-        for (auto card : _reserveCards) {
-            delete card;
-        }
-        if (_activeCard) {
-            delete _activeCard;
-        }
+        CardModel* card = _arena.create<CardModel>(_arena.create<UnreversedStatus>());
+        card->setItemId(_nextCardId++);
+        return card;
+    }
+
+    // Arena holding this game's objects
+    GameArena& getArena() { return _arena; }
+    const GameArena& getArena() const { return _arena; }
+
+    // Seed of the game's random numbers, kept in saves and replays so a
+    // game draws the same numbers when it is resumed or replayed
+    uint32_t getSeed() const { return _seed; }
+    void setSeed(uint32_t seed)
+    {
+        _seed = seed;
+        _random.setSeed(seed);
     }
 
+    // Random numbers of this game; game logic draws from here only
+    GameRandom& getRandom() { return _random; }
+
+    // Draw the seed's numbers from the start again, as when the game began
+    void restartRandom() { _random.setSeed(_seed); }
+
     // Accessor and Mutator for the field cards
+    // Setting the field cards lays them out: the occlusion graph is rebuilt
+    // from their locations and only uncovered cards stay face up
     const std::vector<CardModel*>& getFieldCards() const { return _fieldCards; }
     void setFieldCards(const std::vector<CardModel*>& cards)
     {
         _fieldCards = cards;
-        updateCardDictionary();
+        indexCards();
+        _occlusionGraph.build(_fieldCards);
+        for (auto card : _fieldCards) {
+            card->setReversed(_occlusionGraph.isPlayable(card->getItemId()));
+        }
     }
 
+    /**
+     * Lay out the field of a game already underway
+     * The occlusion graph is built from every card the level dealt to the
+     * field, as setFieldCards() does, then the cards that have left the
+     * field are taken off it again and moved to the bottom card node.
+     * @param layoutCards Cards dealt to the field, in level (draw) order, at their level locations
+     * @param fieldCards The ones still on the field
+     */
+    void setFieldLayout(const std::vector<CardModel*>& layoutCards, const std::vector<CardModel*>& fieldCards)
+    {
+        setFieldCards(layoutCards);
+        _fieldCards = fieldCards;
+        for (auto card : layoutCards) {
+            if (std::find(fieldCards.begin(), fieldCards.end(), card) == fieldCards.end()) {
+                uncoverFieldCards(card->getItemId());
+                card->setLocation(cocos2d::Vec2::ZERO);
+            }
+        }
+    }
+
+    // Which field card covers which
+    const OcclusionGraph& getOcclusionGraph() const { return _occlusionGraph; }
+
+    // A field card can be matched only when no field card lies on top of it
+    bool isCardPlayable(int cardId) const { return _occlusionGraph.isPlayable(cardId); }
+
     // Accessor and Mutator for the active card (the currently displayed card)
     CardModel* getActiveCard() const { return _activeCard; }
     void setActiveCard(CardModel* card)
     {
         _activeCard = card;
         if (card) {
-            _cardDictionary[card->getItemId()] = card;
+            indexCard(card);
         }
     }
 
@@ -126,62 +165,173 @@ public:
     void setReserveCards(const std::vector<CardModel*>& cards)
     {
         _reserveCards = cards;
-        updateCardDictionary();
+        indexCards();
     }
 
     // Retrieve card by ID
     CardModel* getCardById(int cardId) const
     {
-        auto it = _cardDictionary.find(cardId);
-        if (it != _cardDictionary.end()) {
-            return it->second;
-        }
-        return nullptr;
+        return static_cast<unsigned>(cardId) < _cardsById.size() ? _cardsById[cardId] : nullptr;
     }
 
-    // Set the current card action
-    void setCardAction(CardAction* action) {
-        _currentAction = action;
-    }
+    /**
+     * Play a move
+     * A match moves the field card onto the active card, a draw moves the
+     * reserve top there; the replaced active card goes under the reserve.
+     * The matched card is swapped out with the last field card, so the move
+     * can be reverted without shifting the others.
+     * @param move The move; the drawn card, field index and flags are filled in
+     * @return False if the move is not possible, the game is left unchanged
+     */
+    bool applyMove(MoveRecord& move)
+    {
+        CardModel* card = nullptr;
+        switch (move.getType()) {
+        case ActionType::MATCH_CARD: {
+            card = getCardById(move.cardId);
+            auto it = std::find(_fieldCards.begin(), _fieldCards.end(), card);
+            if (!card || it == _fieldCards.end()) {
+                CCLOG("GameModel: Card %d is not on the field", move.cardId);
+                return false;
+            }
+            move.fieldIndex = static_cast<uint16_t>(it - _fieldCards.begin());
+            *it = _fieldCards.back();
+            _fieldCards.pop_back();
+            uncoverFieldCards(move.cardId);
+            card->setLocation(cocos2d::Vec2::ZERO); // Position at the bottom card node
+            break;
+        }
+        case ActionType::DRAW_CARD:
+            if (_reserveCards.empty()) {
+                CCLOG("GameModel: No more cards in the reserve stack");
+                return false;
+            }
+            card = _reserveCards.back();
+            _reserveCards.pop_back();
+            move.cardId = card->getItemId();
+            break;
+        default:
+            CCLOG("GameModel: Unknown move type %d", (int)move.type);
+            return false;
+        }
 
-    // Perform the current card action
-    void performCardAction() {
-        if (_currentAction) {
-            _currentAction->performAction(_fieldCards, _reserveCards, _activeCard, _cardDictionary);
+        move.flags = card->isReversed() ? MoveRecord::kWasFaceUp : 0;
+        if (_activeCard) {
+            move.flags |= MoveRecord::kHadActiveCard;
+            _reserveCards.insert(_reserveCards.begin(), _activeCard);
         }
+        card->setReversed(true);
+        _activeCard = card;
+        return true;
     }
 
-    // Perform draw card action and return the drawn card
-    CardModel* performDrawCardAction() {
-        if (_currentAction) {
-            _currentAction->performAction(_fieldCards, _reserveCards, _activeCard, _cardDictionary);
-            if (auto drawAction = dynamic_cast<DrawCardAction*>(_currentAction)) {
-                return drawAction->getDrawnCard(); // Return the drawn card
-            }
+    /**
+     * Take back the last move played
+     * @param move The record applyMove() filled in
+     * @return False if the move is not the last one played, the game is left unchanged
+     */
+    bool revertMove(const MoveRecord& move)
+    {
+        CardModel* card = _activeCard;
+        bool hadActiveCard = (move.flags & MoveRecord::kHadActiveCard) != 0;
+        bool isMatch = move.getType() == ActionType::MATCH_CARD;
+        if (!card || card->getItemId() != move.cardId || (hadActiveCard && _reserveCards.empty()) ||
+            (isMatch && move.fieldIndex > _fieldCards.size())) {
+            CCLOG("GameModel: Move of card %d is not the last one played", move.cardId);
+            return false;
+        }
+
+        if (isMatch) {
+            // Swap back with the card that took its place
+            card->setLocation(_occlusionGraph.getLocation(move.cardId));
+            _fieldCards.push_back(card);
+            std::swap(_fieldCards[move.fieldIndex], _fieldCards.back());
+            setCardsReversed(_occlusionGraph.restoreCard(move.cardId), false);
+        }
+        else {
+            _reserveCards.push_back(card);
+        }
+        card->setReversed((move.flags & MoveRecord::kWasFaceUp) != 0);
+
+        _activeCard = nullptr;
+        if (hadActiveCard) {
+            _activeCard = _reserveCards.front();
+            _reserveCards.erase(_reserveCards.begin());
+            _activeCard->setReversed(true);
         }
-        return nullptr;
+        return true;
     }
 
 private:
+    GameArena _arena; // Declared first so it outlives everything allocated from it
     std::vector<CardModel*> _fieldCards; // Cards on the field
     CardModel* _activeCard; // The currently active (visible) card
     std::vector<CardModel*> _reserveCards; // The reserve stack of cards
-    std::unordered_map<int, CardModel*> _cardDictionary; // A map for quick card lookup by ID
-    CardAction* _currentAction; // The current card action being executed
+    std::vector<CardModel*> _cardsById; // Cards indexed by ID, nullptr for IDs not in play
+    int _nextCardId; // ID of the next card created
+    uint32_t _seed; // Seed of _random
+    GameRandom _random; // The game's random numbers
+    OcclusionGraph _occlusionGraph; // Overlaps between the field cards
 
-    // Update the card dictionary with the current cards
-    void updateCardDictionary()
+    /**
+     * Update the occlusion graph once a card has left the field
+     * Cards it uncovered turn face up.
+     * @param cardId The removed field card
+     * @return IDs of the uncovered cards, valid until the field changes again
+     */
+    const std::vector<int>& uncoverFieldCards(int cardId)
     {
-        _cardDictionary.clear();
+        const std::vector<int>& uncoveredCards = _occlusionGraph.removeCard(cardId);
+        setCardsReversed(uncoveredCards, true);
+        return uncoveredCards;
+    }
+
+    void setCardsReversed(const std::vector<int>& cardIds, bool reversed)
+    {
+        for (int cardId : cardIds) {
+            CardModel* card = getCardById(cardId);
+            if (card) {
+                card->setReversed(reversed);
+            }
+        }
+    }
+
+    // Rebuild the card lookup from the current cards
+    void indexCards()
+    {
+        _cardsById.assign(_cardsById.size(), nullptr);
         for (auto card : _fieldCards) {
-            _cardDictionary[card->getItemId()] = card;
+            indexCard(card);
         }
         for (auto card : _reserveCards) {
-            _cardDictionary[card->getItemId()] = card;
+            indexCard(card);
         }
         if (_activeCard) {
-            _cardDictionary[_activeCard->getItemId()] = _activeCard;
+            indexCard(_activeCard);
+        }
+        reserveCardCapacity();
+    }
+
+    void indexCard(CardModel* card)
+    {
+        int cardId = card->getItemId();
+        if (cardId < 0) {
+            CCLOG("GameModel: Card ID %d is not a game card ID", cardId);
+            return;
+        }
+        if (static_cast<size_t>(cardId) >= _cardsById.size()) {
+            _cardsById.resize(cardId + 1, nullptr);
         }
+        _cardsById[cardId] = card;
+    }
+
+    // Cards only move between field, reserve and active card, so room for
+    // all of them in each vector keeps moves free of reallocations
+    void reserveCardCapacity()
+    {
+        size_t cardCount = _fieldCards.size() + _reserveCards.size() + (_activeCard ? 1 : 0);
+        _fieldCards.reserve(cardCount);
+        _reserveCards.reserve(cardCount);
     }
 };
 
@@ -0,0 +1,184 @@
+#pragma once
+#ifndef GAME_SNAPSHOT_H
+#define GAME_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Binary snapshot header, followed by
+ *   uint8_t faceUp[(cardCount + 7) / 8] reversed flag per card in level order, one bit each
+ *   uint8_t moves[moveCount]            the move log, one byte per move
+ * Values are stored in the byte order of the writer, with a byte order
+ * mark, as level packs are. The checksum covers everything after the header.
+ */
+struct GameSnapshotHeader
+{
+    char magic[4];          // "SAVE"
+    uint32_t version;
+    uint32_t byteOrderMark; // kByteOrderMark as written
+    int32_t levelId;
+    uint32_t seed;
+    uint16_t cardCount;
+    uint16_t fieldCount;
+    uint32_t moveCount;
+    uint32_t moveCursor;    // Moves played; the ones after it can be redone
+    uint32_t checksum;      // FNV-1a over the bytes after the header
+};
+
+static_assert(sizeof(GameSnapshotHeader) == 36, "GameSnapshotHeader layout is part of the file format");
+
+/**
+ * An in-progress game, small enough to write on every trip to the background
+ * Only what play changed is kept: the face flags and the move log, which
+ * rebuilds where every card is from the level in well under a
+ * millisecond. Cards are named by level index, which is also their card
+ * ID in a game built from the level. 50 cards and 500 moves take about
+ * 550 bytes.
+ */
+class GameSnapshot
+{
+public:
+    static const uint32_t kVersion = 2;
+    static const uint32_t kByteOrderMark = 0x01020304;
+
+    // Move bytes: a draw, or a match of field card (byte - kMatchBase) in level order
+    static const uint8_t kDrawMove = 0;
+    static const uint8_t kMatchBase = 1;
+    static const int kMaxFieldCards = 255 - kMatchBase;
+
+    GameSnapshot() : _levelId(0), _seed(0), _cardCount(0), _fieldCount(0), _moveCursor(0) {}
+
+    void clear()
+    {
+        _levelId = 0;
+        _seed = 0;
+        _cardCount = 0;
+        _fieldCount = 0;
+        _moveCursor = 0;
+        _faceUp.clear();
+        _moves.clear();
+    }
+
+    int getLevelId() const { return _levelId; }
+    void setLevelId(int levelId) { _levelId = levelId; }
+
+    uint32_t getSeed() const { return _seed; }
+    void setSeed(uint32_t seed) { _seed = seed; }
+
+    // Cards of the level, field cards first
+    int getCardCount() const { return _cardCount; }
+    int getFieldCount() const { return _fieldCount; }
+    void setCardCount(int cardCount, int fieldCount)
+    {
+        _cardCount = cardCount;
+        _fieldCount = fieldCount;
+        _faceUp.assign((cardCount + 7) / 8, 0);
+    }
+
+    // Reversed flag of the card at a level index
+    bool isFaceUp(int index) const { return (_faceUp[index >> 3] & (1u << (index & 7))) != 0; }
+    void setFaceUp(int index, bool faceUp)
+    {
+        if (faceUp) {
+            _faceUp[index >> 3] |= static_cast<uint8_t>(1u << (index & 7));
+        }
+        else {
+            _faceUp[index >> 3] &= static_cast<uint8_t>(~(1u << (index & 7)));
+        }
+    }
+
+    const std::vector<uint8_t>& getMoves() const { return _moves; }
+    void addMove(uint8_t move) { _moves.push_back(move); }
+
+    uint32_t getMoveCursor() const { return _moveCursor; }
+    void setMoveCursor(uint32_t moveCursor) { _moveCursor = moveCursor; }
+
+    /**
+     * Write the snapshot in the binary format
+     * @param bytes Receives the file contents
+     */
+    void serialize(std::vector<uint8_t>& bytes) const
+    {
+        GameSnapshotHeader header;
+        std::memcpy(header.magic, "SAVE", 4);
+        header.version = kVersion;
+        header.byteOrderMark = kByteOrderMark;
+        header.levelId = _levelId;
+        header.seed = _seed;
+        header.cardCount = static_cast<uint16_t>(_cardCount);
+        header.fieldCount = static_cast<uint16_t>(_fieldCount);
+        header.moveCount = static_cast<uint32_t>(_moves.size());
+        header.moveCursor = _moveCursor;
+
+        bytes.resize(sizeof(GameSnapshotHeader) + _faceUp.size() + _moves.size());
+        uint8_t* body = bytes.data() + sizeof(GameSnapshotHeader);
+        copyBytes(body, _faceUp);
+        copyBytes(body + _faceUp.size(), _moves);
+
+        header.checksum = checksum(body, bytes.size() - sizeof(GameSnapshotHeader));
+        std::memcpy(bytes.data(), &header, sizeof(GameSnapshotHeader));
+    }
+
+    /**
+     * Read a snapshot written by serialize()
+     * @return False if the bytes are not an intact snapshot of this version and byte order
+     */
+    bool deserialize(const uint8_t* bytes, size_t size)
+    {
+        GameSnapshotHeader header;
+        if (!bytes || size < sizeof(GameSnapshotHeader)) {
+            return false;
+        }
+        std::memcpy(&header, bytes, sizeof(GameSnapshotHeader));
+        if (std::memcmp(header.magic, "SAVE", 4) != 0 || header.version != kVersion ||
+            header.byteOrderMark != kByteOrderMark || header.fieldCount > header.cardCount ||
+            header.moveCursor > header.moveCount) {
+            return false;
+        }
+
+        size_t faceBytes = (header.cardCount + 7) / 8;
+        const uint8_t* body = bytes + sizeof(GameSnapshotHeader);
+        size_t bodySize = size - sizeof(GameSnapshotHeader);
+        if (bodySize != faceBytes + header.moveCount || checksum(body, bodySize) != header.checksum) {
+            return false;
+        }
+
+        _levelId = header.levelId;
+        _seed = header.seed;
+        _cardCount = header.cardCount;
+        _fieldCount = header.fieldCount;
+        _moveCursor = header.moveCursor;
+        _faceUp.assign(body, body + faceBytes);
+        _moves.assign(body + faceBytes, body + bodySize);
+        return true;
+    }
+
+private:
+    static void copyBytes(uint8_t* destination, const std::vector<uint8_t>& source)
+    {
+        if (!source.empty()) {
+            std::memcpy(destination, source.data(), source.size());
+        }
+    }
+
+    static uint32_t checksum(const uint8_t* bytes, size_t size)
+    {
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < size; ++i) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    int _levelId;
+    uint32_t _seed;
+    int _cardCount;
+    int _fieldCount;
+    uint32_t _moveCursor;
+    std::vector<uint8_t> _faceUp;
+    std::vector<uint8_t> _moves;
+};
+
+#endif // GAME_SNAPSHOT_H
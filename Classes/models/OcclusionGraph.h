@@ -0,0 +1,217 @@
+#pragma once
+#ifndef OCCLUSION_GRAPH_H
+#define OCCLUSION_GRAPH_H
+
+#include "cocos2d.h"
+#include "CardModel.h"
+#include <cmath>
+#include <vector>
+
+/**
+ * Which field card covers which
+ * Field cards are drawn in level order, so a card covers every earlier
+ * card its rect overlaps. The edges are found once when the level is
+ * loaded; afterwards only cover counts change as cards leave and return,
+ * which keeps "is this card playable" a lookup and hands out the cards a
+ * move uncovered without rescanning the board.
+ *
+ * Nodes are numbered in level order, which is also the draw order views
+ * stack the cards in. Card IDs are dense within a game, so nodes are
+ * found by indexing with the card ID.
+ */
+class OcclusionGraph
+{
+public:
+    // Size of res/card_general.png, the card the views draw
+    static constexpr float kCardWidth = 182.0f;
+    static constexpr float kCardHeight = 282.0f;
+
+    OcclusionGraph() {}
+
+    OcclusionGraph(const OcclusionGraph&) = delete;
+    OcclusionGraph& operator=(const OcclusionGraph&) = delete;
+
+    /**
+     * Find the edges between field cards
+     * Every card starts on the field.
+     * @param fieldCards Field cards in level (draw) order
+     * @param cardSize Card size; card locations are card centres
+     */
+    void build(const std::vector<CardModel*>& fieldCards, const cocos2d::Size& cardSize = cocos2d::Size(kCardWidth, kCardHeight))
+    {
+        clear();
+
+        int count = static_cast<int>(fieldCards.size());
+        _nodes.resize(count);
+        for (int i = 0; i < count; ++i) {
+            int cardId = fieldCards[i]->getItemId();
+            _nodes[i].cardId = cardId;
+            _nodes[i].location = fieldCards[i]->getLocation();
+            if (cardId < 0) {
+                continue;
+            }
+            if (static_cast<size_t>(cardId) >= _nodeByCard.size()) {
+                _nodeByCard.resize(cardId + 1, -1);
+            }
+            _nodeByCard[cardId] = i;
+        }
+
+        // Edges in both directions, stored as offset + list per node
+        std::vector<std::vector<int>> above(count);
+        for (int upper = 0; upper < count; ++upper) {
+            _belowOffsets.push_back(static_cast<int>(_below.size()));
+            for (int lower = 0; lower < upper; ++lower) {
+                const cocos2d::Vec2& upperLocation = _nodes[upper].location;
+                const cocos2d::Vec2& lowerLocation = _nodes[lower].location;
+                if (std::fabs(upperLocation.x - lowerLocation.x) < cardSize.width &&
+                    std::fabs(upperLocation.y - lowerLocation.y) < cardSize.height) {
+                    _below.push_back(lower);
+                    above[lower].push_back(upper);
+                }
+            }
+        }
+        _belowOffsets.push_back(static_cast<int>(_below.size()));
+
+        for (int i = 0; i < count; ++i) {
+            _aboveOffsets.push_back(static_cast<int>(_above.size()));
+            _above.insert(_above.end(), above[i].begin(), above[i].end());
+            _nodes[i].coverCount = static_cast<int>(above[i].size());
+        }
+        _aboveOffsets.push_back(static_cast<int>(_above.size()));
+
+        CCLOG("OcclusionGraph: %d cards, %d overlaps", count, (int)_below.size());
+    }
+
+    void clear()
+    {
+        _nodes.clear();
+        _nodeByCard.clear();
+        _belowOffsets.clear();
+        _below.clear();
+        _aboveOffsets.clear();
+        _above.clear();
+        _changedCards.clear();
+    }
+
+    int getCardCount() const { return static_cast<int>(_nodes.size()); }
+    int getEdgeCount() const { return static_cast<int>(_below.size()); }
+
+    bool contains(int cardId) const { return findNode(cardId) >= 0; }
+
+    /**
+     * Draw order of a field card
+     * @return Its level index, later cards are drawn on top; -1 if unknown
+     */
+    int getLayer(int cardId) const { return findNode(cardId); }
+
+    bool isOnField(int cardId) const
+    {
+        int node = findNode(cardId);
+        return node >= 0 && _nodes[node].onField;
+    }
+
+    // On the field and not covered by any card still on the field
+    bool isPlayable(int cardId) const
+    {
+        int node = findNode(cardId);
+        return node >= 0 && _nodes[node].onField && _nodes[node].coverCount == 0;
+    }
+
+    // Where a card lies in the level layout, also once it has left the field
+    cocos2d::Vec2 getLocation(int cardId) const
+    {
+        int node = findNode(cardId);
+        return node >= 0 ? _nodes[node].location : cocos2d::Vec2::ZERO;
+    }
+
+    // Number of cards on the field lying on top of a card
+    int getCoverCount(int cardId) const
+    {
+        int node = findNode(cardId);
+        return node >= 0 ? _nodes[node].coverCount : 0;
+    }
+
+    /**
+     * Take a card off the field
+     * @return Field cards left uncovered by it, valid until the next change
+     */
+    const std::vector<int>& removeCard(int cardId)
+    {
+        _changedCards.clear();
+        int node = findNode(cardId);
+        if (node < 0 || !_nodes[node].onField) {
+            return _changedCards;
+        }
+        _nodes[node].onField = false;
+        for (int i = _belowOffsets[node]; i < _belowOffsets[node + 1]; ++i) {
+            Node& lower = _nodes[_below[i]];
+            if (--lower.coverCount == 0 && lower.onField) {
+                _changedCards.push_back(lower.cardId);
+            }
+        }
+        return _changedCards;
+    }
+
+    /**
+     * Put a card back on the field, e.g. when a match is undone
+     * @return Field cards it covers again, valid until the next change
+     */
+    const std::vector<int>& restoreCard(int cardId)
+    {
+        _changedCards.clear();
+        int node = findNode(cardId);
+        if (node < 0 || _nodes[node].onField) {
+            return _changedCards;
+        }
+        _nodes[node].onField = true;
+        for (int i = _belowOffsets[node]; i < _belowOffsets[node + 1]; ++i) {
+            Node& lower = _nodes[_below[i]];
+            if (lower.coverCount++ == 0 && lower.onField) {
+                _changedCards.push_back(lower.cardId);
+            }
+        }
+        return _changedCards;
+    }
+
+    /**
+     * Visit the cards lying on top of a card, whether on the field or not
+     * @param function Called with each card ID
+     */
+    template <typename Function>
+    void forEachCardAbove(int cardId, Function function) const
+    {
+        int node = findNode(cardId);
+        if (node < 0) {
+            return;
+        }
+        for (int i = _aboveOffsets[node]; i < _aboveOffsets[node + 1]; ++i) {
+            function(_nodes[_above[i]].cardId);
+        }
+    }
+
+private:
+    struct Node
+    {
+        Node() : cardId(0), coverCount(0), onField(true) {}
+
+        int cardId;
+        cocos2d::Vec2 location; // Level layout position
+        int coverCount;         // Cards above it that are on the field
+        bool onField;
+    };
+
+    int findNode(int cardId) const
+    {
+        return static_cast<unsigned>(cardId) < _nodeByCard.size() ? _nodeByCard[cardId] : -1;
+    }
+
+    std::vector<Node> _nodes;                  // Indexed by level order
+    std::vector<int> _nodeByCard;              // Node by card ID, -1 for cards not on the field
+    std::vector<int> _belowOffsets;            // Node n covers _below[_belowOffsets[n] .. _belowOffsets[n + 1])
+    std::vector<int> _below;
+    std::vector<int> _aboveOffsets;            // Node n is covered by _above[_aboveOffsets[n] .. _aboveOffsets[n + 1])
+    std::vector<int> _above;
+    std::vector<int> _changedCards;            // Result buffer of removeCard() / restoreCard()
+};
+
+#endif // OCCLUSION_GRAPH_H
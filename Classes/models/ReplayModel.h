@@ -0,0 +1,156 @@
+#pragma once
+#ifndef REPLAY_MODEL_H
+#define REPLAY_MODEL_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * Recorded player inputs, one per GameController entry point
+ */
+enum class ReplayEventType : uint8_t
+{
+    MATCH, // handleCardSelection
+    DRAW,  // handleCardDraw
+    UNDO,  // handleUndo
+    REDO   // handleRedo
+};
+
+/**
+ * One recorded input, packed into 16 bits
+ * Cards are named by their index in the level (field cards in level order,
+ * then the stack cards in config order), which is the same in every run,
+ * unlike card IDs.
+ */
+struct ReplayEvent
+{
+    static const uint16_t kMaxCardIndex = 0x3FFF;
+
+    static ReplayEvent make(ReplayEventType type, int cardIndex = 0)
+    {
+        ReplayEvent event;
+        event.code = static_cast<uint16_t>((static_cast<unsigned>(type) << 14) | (cardIndex & kMaxCardIndex));
+        return event;
+    }
+
+    ReplayEventType getType() const { return static_cast<ReplayEventType>(code >> 14); }
+    int getCardIndex() const { return code & kMaxCardIndex; }
+
+    uint16_t code; // Type in the top two bits, level card index below
+};
+
+static_assert(sizeof(ReplayEvent) == 2, "ReplayEvent is written to replay files as is");
+
+/**
+ * Binary replay file header, followed by eventCount ReplayEvents
+ * Values are stored in the byte order of the writer, with a byte order
+ * mark, as level packs are.
+ */
+struct ReplayHeader
+{
+    char magic[4];          // "RPLY"
+    uint32_t version;
+    uint32_t byteOrderMark; // kByteOrderMark as written
+    int32_t levelId;
+    uint32_t seed;
+    uint32_t eventCount;
+    uint64_t finalHash;     // ReplaySimulator::hashGameState() after the last event
+};
+
+static_assert(sizeof(ReplayHeader) == 32, "ReplayHeader layout is part of the file format");
+
+/**
+ * One recorded game session
+ * The level, the seed of the session and every input in order; replaying
+ * the inputs from the level's start must end in the recorded state hash.
+ * A 500-move session is about 1KB.
+ */
+class ReplayModel
+{
+public:
+    static const uint32_t kVersion = 1;
+    static const uint32_t kByteOrderMark = 0x01020304;
+
+    ReplayModel() : _levelId(0), _seed(0), _finalHash(0) {}
+
+    /**
+     * Start a new recording
+     * @param levelId Level being played
+     * @param seed Seed of the session's random numbers
+     */
+    void reset(int levelId, uint32_t seed)
+    {
+        _levelId = levelId;
+        _seed = seed;
+        _finalHash = 0;
+        _events.clear();
+    }
+
+    void addEvent(const ReplayEvent& event) { _events.push_back(event); }
+
+    int getLevelId() const { return _levelId; }
+    uint32_t getSeed() const { return _seed; }
+    const std::vector<ReplayEvent>& getEvents() const { return _events; }
+
+    uint64_t getFinalHash() const { return _finalHash; }
+    void setFinalHash(uint64_t hash) { _finalHash = hash; }
+
+    /**
+     * Write the replay in the binary file format
+     * @param bytes Receives the file contents
+     */
+    void serialize(std::vector<uint8_t>& bytes) const
+    {
+        ReplayHeader header;
+        std::memcpy(header.magic, "RPLY", 4);
+        header.version = kVersion;
+        header.byteOrderMark = kByteOrderMark;
+        header.levelId = _levelId;
+        header.seed = _seed;
+        header.eventCount = static_cast<uint32_t>(_events.size());
+        header.finalHash = _finalHash;
+
+        size_t eventBytes = _events.size() * sizeof(ReplayEvent);
+        bytes.resize(sizeof(ReplayHeader) + eventBytes);
+        std::memcpy(bytes.data(), &header, sizeof(ReplayHeader));
+        if (eventBytes > 0) {
+            std::memcpy(bytes.data() + sizeof(ReplayHeader), _events.data(), eventBytes);
+        }
+    }
+
+    /**
+     * Read a replay written by serialize()
+     * @return False if the bytes are not a replay of this version and byte order
+     */
+    bool deserialize(const uint8_t* bytes, size_t size)
+    {
+        ReplayHeader header;
+        if (!bytes || size < sizeof(ReplayHeader)) {
+            return false;
+        }
+        std::memcpy(&header, bytes, sizeof(ReplayHeader));
+        if (std::memcmp(header.magic, "RPLY", 4) != 0 || header.version != kVersion ||
+            header.byteOrderMark != kByteOrderMark ||
+            (size - sizeof(ReplayHeader)) / sizeof(ReplayEvent) != header.eventCount) {
+            return false;
+        }
+
+        _levelId = header.levelId;
+        _seed = header.seed;
+        _finalHash = header.finalHash;
+        _events.resize(header.eventCount);
+        if (header.eventCount > 0) {
+            std::memcpy(_events.data(), bytes + sizeof(ReplayHeader), header.eventCount * sizeof(ReplayEvent));
+        }
+        return true;
+    }
+
+private:
+    int _levelId;
+    uint32_t _seed;
+    uint64_t _finalHash;
+    std::vector<ReplayEvent> _events;
+};
+
+#endif // REPLAY_MODEL_H
@@ -37,10 +37,22 @@ public:
         setupSceneBackground();
         initializeController();
         createResetButton();
+        createRedoButton();
+        createHintButton();
 
         return true;
     }
 
+    /**
+     * Save the game in progress, to be resumed on the next launch
+     */
+    void saveGame()
+    {
+        if (_controller) {
+            _controller->saveGame();
+        }
+    }
+
 private:
     void setupSceneBackground()
     {
@@ -51,7 +63,12 @@ private:
     void initializeController()
     {
         _controller = new GameController();
-        _controller->beginGame(1);
+
+        // Continue the saved game if there is one, otherwise start from the first level
+        GameSnapshot snapshot;
+        if (!GameSaveManager::getInstance().loadSnapshot(snapshot) || !_controller->resumeGame(snapshot)) {
+            _controller->beginGame(1);
+        }
 
         if (_controller->getGameView()) {
             addChild(_controller->getGameView());
@@ -60,22 +77,37 @@ private:
 
     void createResetButton()
     {
-        auto resetBtn = Button::create("");
-        resetBtn->setTitleText("back");
-        resetBtn->setTitleFontSize(60);
-        resetBtn->setTitleColor(Color3B::WHITE);
-        resetBtn->setColor(Color3B(255, 200, 0));
-        resetBtn->setContentSize(Size(220, 90));
-        resetBtn->setOpacity(230);
-        resetBtn->setPosition(Vec2(260, 300));
-
-        resetBtn->addTouchEventListener([this](Ref* sender, ui::Widget::TouchEventType type) {
-            handleResetButtonEvent(sender, type);
+        createSceneButton("back", Vec2(260, 300), [this]() { this->onResetButtonClicked(); });
+    }
+
+    void createRedoButton()
+    {
+        createSceneButton("redo", Vec2(260, 420), [this]() { this->onRedoButtonClicked(); });
+    }
+
+    void createHintButton()
+    {
+        createSceneButton("hint", Vec2(260, 180), [this]() { this->onHintButtonClicked(); });
+    }
+
+    void createSceneButton(const std::string& title, const Vec2& position, const std::function<void()>& onClicked)
+    {
+        auto button = Button::create("");
+        button->setTitleText(title);
+        button->setTitleFontSize(60);
+        button->setTitleColor(Color3B::WHITE);
+        button->setColor(Color3B(255, 200, 0));
+        button->setContentSize(Size(220, 90));
+        button->setOpacity(230);
+        button->setPosition(position);
+
+        button->addTouchEventListener([this, onClicked](Ref* sender, ui::Widget::TouchEventType type) {
+            handleButtonEvent(sender, type, onClicked);
             });
-        addChild(resetBtn);
+        addChild(button);
     }
 
-    void handleResetButtonEvent(Ref* sender, ui::Widget::TouchEventType type)
+    void handleButtonEvent(Ref* sender, ui::Widget::TouchEventType type, const std::function<void()>& onClicked)
     {
         auto button = static_cast<ui::Button*>(sender);
         switch (type) {
@@ -86,7 +118,10 @@ private:
         case ui::Widget::TouchEventType::ENDED:
             button->setScale(1.0f);
             button->setColor(Color3B(255, 200, 0));
-            this->onResetButtonClicked();
+            // The game is driven by the replay while one plays back
+            if (!_controller || !_controller->isReplaying()) {
+                onClicked();
+            }
             break;
         case ui::Widget::TouchEventType::CANCELED:
             button->setScale(1.0f);
@@ -104,6 +139,20 @@ private:
         }
     }
 
+    void onRedoButtonClicked()
+    {
+        if (_controller) {
+            _controller->handleRedo();
+        }
+    }
+
+    void onHintButtonClicked()
+    {
+        if (_controller) {
+            _controller->requestHint();
+        }
+    }
+
     GameController* _controller; // Game controller
 };
 
@@ -0,0 +1,370 @@
+#pragma once
+#ifndef DIFFICULTY_ESTIMATOR_H
+#define DIFFICULTY_ESTIMATOR_H
+
+#include "cocos2d.h"
+#include "../models/CompactGameState.h"
+#include "../configs/models/LevelConfig.h"
+#include "../utils/GameRandom.h"
+#include "../utils/GameUtils.h"
+#include "../utils/WorkStealingScheduler.h"
+#include "GameModelFromLevelGenerator.h"
+#include "MoveGenerator.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * How a simulated player picks its next move
+ */
+enum class PlayoutPolicy
+{
+    RANDOM,          // Any legal move, draws included
+    GREEDY_UNCOVER,  // The match uncovering the most cards; draws only when nothing matches
+    LOOKAHEAD        // The move leading to the best few-move sequence
+};
+
+/**
+ * Estimator settings
+ */
+struct EstimatorOptions
+{
+    EstimatorOptions()
+        : playouts(100000), seed(1), policy(PlayoutPolicy::GREEDY_UNCOVER), lookaheadDepth(2), maxMoves(500)
+    {
+    }
+
+    int playouts;
+    uint64_t seed;         // The same seed, level and options always give the same estimate
+    PlayoutPolicy policy;
+    int lookaheadDepth;    // Moves looked ahead by the LOOKAHEAD policy
+    int maxMoves;          // A playout still going after this many moves counts as lost
+};
+
+/**
+ * Expected outcome of a level under a player policy
+ */
+struct DifficultyEstimate
+{
+    DifficultyEstimate()
+        : playouts(0), wins(0), winRate(0.0), winRateLow(0.0), winRateHigh(0.0),
+          averageRemainingCards(0.0), averageDraws(0.0), averageMoves(0.0), elapsedMs(0.0)
+    {
+    }
+
+    int playouts;
+    int wins;
+    double winRate;
+    double winRateLow;            // 95% Wilson score interval of the win rate
+    double winRateHigh;
+    double averageRemainingCards; // Field cards left when a playout ended
+    double averageDraws;
+    double averageMoves;
+    double elapsedMs;
+};
+
+/**
+ * Monte Carlo difficulty estimation
+ * Plays a level many times with a simulated player on compact states and
+ * reports how often it is won. A playout ends when the field is cleared,
+ * when no move is left, or when a whole turn of the reserve passed without
+ * a match being possible, as the reserve then only repeats itself.
+ *
+ * Playouts are run in fixed-size chunks across the scheduler's workers.
+ * Every chunk draws from its own stream of the seed, the chunk index, so
+ * the estimate does not depend on the number of threads.
+ */
+class DifficultyEstimator
+{
+public:
+    static const int kPlayoutsPerChunk = 1024;
+
+    DifficultyEstimator() : _prepared(false) {}
+
+    // The move generator points into the card table
+    DifficultyEstimator(const DifficultyEstimator&) = delete;
+    DifficultyEstimator& operator=(const DifficultyEstimator&) = delete;
+
+    /**
+     * Set up a level
+     * @return False if the level holds more than CompactCardTable::kMaxCards cards
+     */
+    bool prepare(const LevelConfig& levelConfig)
+    {
+        GameModelFromLevelGenerator generator;
+        GameModel* gameModel = generator.createGameModelFromLevel(levelConfig);
+        _prepared = CompactGameState::fromGameModel(*gameModel, _table, _initialState);
+        delete gameModel;
+        if (_prepared) {
+            _moveGenerator.setup(_table);
+        }
+        return _prepared;
+    }
+
+    /**
+     * Run the playouts
+     * @param options Estimator settings
+     * @param scheduler Workers to run the chunks on
+     */
+    DifficultyEstimate estimate(const EstimatorOptions& options, WorkStealingScheduler& scheduler) const
+    {
+        DifficultyEstimate estimate;
+        if (!_prepared || options.playouts <= 0) {
+            return estimate;
+        }
+
+        auto startTime = std::chrono::steady_clock::now();
+        size_t chunkCount = (options.playouts + kPlayoutsPerChunk - 1) / kPlayoutsPerChunk;
+        std::vector<PlayoutTotals> chunks(chunkCount);
+        scheduler.run(chunkCount, [&](size_t chunk, int) {
+            GameRandom random(options.seed, chunk);
+            int begin = static_cast<int>(chunk) * kPlayoutsPerChunk;
+            int end = begin + kPlayoutsPerChunk < options.playouts ? begin + kPlayoutsPerChunk : options.playouts;
+            for (int i = begin; i < end; ++i) {
+                chunks[chunk].add(playout(options, random));
+            }
+        });
+
+        // Summed in chunk order, so the totals are the same on any thread count
+        PlayoutTotals totals;
+        for (const auto& chunk : chunks) {
+            totals.merge(chunk);
+        }
+
+        double count = static_cast<double>(options.playouts);
+        estimate.playouts = options.playouts;
+        estimate.wins = totals.wins;
+        estimate.winRate = totals.wins / count;
+        wilsonInterval(totals.wins, options.playouts, estimate.winRateLow, estimate.winRateHigh);
+        estimate.averageRemainingCards = totals.remainingCards / count;
+        estimate.averageDraws = totals.draws / count;
+        estimate.averageMoves = totals.moves / count;
+        estimate.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        return estimate;
+    }
+
+    static const char* getPolicyName(PlayoutPolicy policy)
+    {
+        switch (policy) {
+        case PlayoutPolicy::RANDOM:
+            return "random";
+        case PlayoutPolicy::GREEDY_UNCOVER:
+            return "greedy";
+        case PlayoutPolicy::LOOKAHEAD:
+            return "lookahead";
+        }
+        return "unknown";
+    }
+
+private:
+    // Outcome of one playout
+    struct PlayoutResult
+    {
+        bool won;
+        int remainingCards;
+        int draws;
+        int moves;
+    };
+
+    struct PlayoutTotals
+    {
+        PlayoutTotals() : wins(0), remainingCards(0), draws(0), moves(0) {}
+
+        void add(const PlayoutResult& result)
+        {
+            wins += result.won ? 1 : 0;
+            remainingCards += result.remainingCards;
+            draws += result.draws;
+            moves += result.moves;
+        }
+
+        void merge(const PlayoutTotals& other)
+        {
+            wins += other.wins;
+            remainingCards += other.remainingCards;
+            draws += other.draws;
+            moves += other.moves;
+        }
+
+        int wins;
+        int64_t remainingCards;
+        int64_t draws;
+        int64_t moves;
+    };
+
+    static const int kNoMove = -1; // A draw, where moves are field slots
+
+    // Lookahead scores: a cleared field beats any sequence, a match gains, a draw costs
+    static const int kMatchScore = 2;
+    static const int kDrawScore = -1;
+    static const int kClearScore = 1000;
+
+    PlayoutResult playout(const EstimatorOptions& options, GameRandom& random) const
+    {
+        CompactGameState state = _initialState;
+        PlayoutResult result = PlayoutResult();
+        int idleDraws = 0; // Draws in a row with nothing to match
+        while (!state.isFieldCleared() && result.moves < options.maxMoves) {
+            LegalMoves legalMoves = _moveGenerator.generate(state);
+            if (legalMoves.isEmpty()) {
+                break;
+            }
+            if (legalMoves.matches) {
+                idleDraws = 0;
+            }
+            else if (++idleDraws >= state.reserveCount + 1) {
+                break; // Every card of the reserve was on top once, nothing will change
+            }
+
+            int slot = chooseMove(options, state, legalMoves, random);
+            if (slot == kNoMove) {
+                state.applyDraw();
+                result.draws++;
+            }
+            else {
+                state.applyMatch(static_cast<uint8_t>(slot));
+            }
+            result.moves++;
+        }
+        result.won = state.isFieldCleared();
+        result.remainingCards = GameUtils::countBits(state.fieldMask);
+        return result;
+    }
+
+    int chooseMove(const EstimatorOptions& options, const CompactGameState& state, const LegalMoves& legalMoves,
+        GameRandom& random) const
+    {
+        switch (options.policy) {
+        case PlayoutPolicy::RANDOM: {
+            int choice = static_cast<int>(random.nextBelow(static_cast<uint32_t>(legalMoves.getCount())));
+            for (uint64_t bits = legalMoves.matches; bits; bits &= bits - 1, --choice) {
+                if (choice == 0) {
+                    return GameUtils::lowestBitIndex(bits);
+                }
+            }
+            return kNoMove;
+        }
+        case PlayoutPolicy::GREEDY_UNCOVER:
+            return chooseGreedy(state, legalMoves, random);
+        case PlayoutPolicy::LOOKAHEAD:
+            return chooseLookahead(state, legalMoves, options.lookaheadDepth, random);
+        }
+        return kNoMove;
+    }
+
+    // The match that leaves the most field cards uncovered, ties at random
+    int chooseGreedy(const CompactGameState& state, const LegalMoves& legalMoves, GameRandom& random) const
+    {
+        int bestSlot = kNoMove;
+        int bestCount = -1;
+        uint32_t ties = 0;
+        for (uint64_t bits = legalMoves.matches; bits; bits &= bits - 1) {
+            int slot = GameUtils::lowestBitIndex(bits);
+            int count = countUncovered(state.fieldMask, slot);
+            if (count > bestCount) {
+                bestSlot = slot;
+                bestCount = count;
+                ties = 1;
+            }
+            else if (count == bestCount && random.nextBelow(++ties) == 0) {
+                bestSlot = slot;
+            }
+        }
+        return bestSlot;
+    }
+
+    // Field cards that only a slot still covers
+    int countUncovered(uint64_t fieldMask, int slot) const
+    {
+        uint64_t remaining = fieldMask & ~(1ULL << slot);
+        int count = 0;
+        for (uint64_t bits = _table.getBelowMask(slot) & remaining; bits; bits &= bits - 1) {
+            if (!(_table.getAboveMask(GameUtils::lowestBitIndex(bits)) & remaining)) {
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // The move starting the best sequence of up to depth moves, ties at random
+    int chooseLookahead(const CompactGameState& state, const LegalMoves& legalMoves, int depth,
+        GameRandom& random) const
+    {
+        int bestSlot = kNoMove;
+        int bestScore = 0;
+        uint32_t ties = 0;
+        for (uint64_t bits = legalMoves.matches; bits; bits &= bits - 1) {
+            int slot = GameUtils::lowestBitIndex(bits);
+            CompactGameState next = state;
+            next.applyMatch(static_cast<uint8_t>(slot));
+            int score = kMatchScore + scoreSequences(next, depth - 1);
+            if (ties == 0 || score > bestScore) {
+                bestSlot = slot;
+                bestScore = score;
+                ties = 1;
+            }
+            else if (score == bestScore && random.nextBelow(++ties) == 0) {
+                bestSlot = slot;
+            }
+        }
+        if (legalMoves.canDraw) {
+            CompactGameState next = state;
+            next.applyDraw();
+            int score = kDrawScore + scoreSequences(next, depth - 1);
+            if (ties == 0 || score > bestScore) {
+                bestSlot = kNoMove;
+            }
+            else if (score == bestScore && random.nextBelow(++ties) == 0) {
+                bestSlot = kNoMove;
+            }
+        }
+        return bestSlot;
+    }
+
+    // Best score reachable from a state in up to depth moves
+    int scoreSequences(const CompactGameState& state, int depth) const
+    {
+        if (state.isFieldCleared()) {
+            return kClearScore;
+        }
+        if (depth <= 0) {
+            return 0;
+        }
+        LegalMoves legalMoves = _moveGenerator.generate(state);
+        int best = 0;
+        for (uint64_t bits = legalMoves.matches; bits; bits &= bits - 1) {
+            CompactGameState next = state;
+            next.applyMatch(static_cast<uint8_t>(GameUtils::lowestBitIndex(bits)));
+            int score = kMatchScore + scoreSequences(next, depth - 1);
+            best = score > best ? score : best;
+        }
+        if (legalMoves.canDraw) {
+            CompactGameState next = state;
+            next.applyDraw();
+            int score = kDrawScore + scoreSequences(next, depth - 1);
+            best = score > best ? score : best;
+        }
+        return best;
+    }
+
+    // 95% Wilson score interval, which stays inside [0, 1] for rates near 0 or 1
+    static void wilsonInterval(int wins, int count, double& low, double& high)
+    {
+        const double z = 1.959963984540054;
+        double n = static_cast<double>(count);
+        double rate = wins / n;
+        double denominator = 1.0 + z * z / n;
+        double centre = (rate + z * z / (2.0 * n)) / denominator;
+        double margin = z * std::sqrt(rate * (1.0 - rate) / n + z * z / (4.0 * n * n)) / denominator;
+        low = centre - margin > 0.0 ? centre - margin : 0.0;
+        high = centre + margin < 1.0 ? centre + margin : 1.0;
+    }
+
+    bool _prepared;
+    CompactCardTable _table;
+    CompactGameState _initialState;
+    MoveGenerator _moveGenerator;
+};
+
+#endif // DIFFICULTY_ESTIMATOR_H
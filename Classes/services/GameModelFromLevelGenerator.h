@@ -3,8 +3,8 @@
 #define LEVEL_TO_GAME_MODEL_BUILDER_H
 
 #include "../models/CardModel.h"
+#include "../models/GameModel.h"
 #include "../configs/models/LevelConfig.h"
-#include "../utils/GameUtils.h"
 
 /**
  * ɸ
@@ -15,14 +15,17 @@ class CardAssembler
 public:
     /**
      * ɿʵ
+     * @param gameModel ϷģͣƷڴ
      * @param cardConfig 
-     * @param cardId ID
-     * @return µĿʵ
+     * @return µĿʵIDϷģͷ䣻ʧܷnullptr
      */
-    CardModel* assembleCard(const LevelConfig::CardItem& cardConfig, int cardId)
+    CardModel* assembleCard(GameModel* gameModel, const LevelConfig::CardItem& cardConfig)
     {
-        CardModel* card = new CardModel();
-        card->setItemId(cardId);
+        CardModel* card = gameModel->createCard();
+        if (!card) {
+            CCLOG("CardAssembler: Failed to allocate card");
+            return nullptr;
+        }
         card->setFaceType(cardConfig.cardValue);
         card->setSuitType(cardConfig.cardSuit);
         card->setLocation(cardConfig.cardPosition);
@@ -44,10 +47,11 @@ public:
 
     /**
      * ݹؿϷģ
+     * ư˳򴴽ǰIDڹؿеţÿοֶͬ
      * @param levelConfig ؿ
      * @return Ϸģʵ
      */
-    GameModel* createGameModelFromLevel(LevelConfig& levelConfig)
+    GameModel* createGameModelFromLevel(const LevelConfig& levelConfig)
     {
         GameModel* newGameModel = new GameModel();
 
@@ -55,8 +59,7 @@ public:
         std::vector<CardModel*> playAreaCards;
         const std::vector<LevelConfig::CardItem>& playAreaConfigurations = levelConfig.getMainAreaCards();
         for (const auto& cardConfig : playAreaConfigurations) {
-            int cardId = GameUtils::createUniqueCardId();
-            CardModel* card = _cardAssembler->assembleCard(cardConfig, cardId);
+            CardModel* card = _cardAssembler->assembleCard(newGameModel, cardConfig);
             if (card) {
                 playAreaCards.push_back(card);
             }
@@ -67,8 +70,7 @@ public:
         std::vector<CardModel*> reserveCards;
         const std::vector<LevelConfig::CardItem>& reserveConfigurations = levelConfig.getBackupAreaCards();
         for (const auto& cardConfig : reserveConfigurations) {
-            int cardId = GameUtils::createUniqueCardId();
-            CardModel* card = _cardAssembler->assembleCard(cardConfig, cardId);
+            CardModel* card = _cardAssembler->assembleCard(newGameModel, cardConfig);
             if (card) {
                 reserveCards.push_back(card);
             }
@@ -0,0 +1,247 @@
+#pragma once
+#ifndef HINT_SEARCH_H
+#define HINT_SEARCH_H
+
+#include "../models/GameModel.h"
+#include "../models/CompactGameState.h"
+#include "../utils/GameUtils.h"
+#include "LevelSolver.h"
+#include "MoveGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <climits>
+
+/**
+ * Hint search settings
+ */
+struct HintOptions
+{
+    HintOptions() : maxDepth(8), budgetMs(50), wrapAround(false) {}
+
+    int maxDepth;    // Deepest lookahead, in moves
+    int budgetMs;    // Wall time limit of one search
+    bool wrapAround; // Kings and aces also match each other
+};
+
+/**
+ * Hint search output
+ */
+struct HintResult
+{
+    HintResult() : found(false), score(0), depth(0), nodes(0), timedOut(false), cancelled(false)
+    {
+        move.type = ActionType::MATCH_CARD;
+        move.cardId = 0;
+    }
+
+    bool found;       // False if no move is legal
+    SolverMove move;  // The suggested next move
+    int score;        // Evaluation of the best line
+    int depth;        // Deepest lookahead completed
+    uint64_t nodes;   // States visited
+    bool timedOut;    // The budget ran out before maxDepth was reached
+    bool cancelled;   // The caller gave up on the search
+};
+
+/**
+ * Best next move by bounded lookahead
+ * Iterative deepening over the moves of MoveGenerator, scoring the leaves
+ * by cards left on the field and cards left uncovered, and treating dead
+ * ends as lost. Each completed depth replaces the previous answer, so the
+ * search can stop at its time budget or on cancellation with the best
+ * answer so far.
+ *
+ * prepare() copies the game into compact form on the calling thread;
+ * search() only touches that copy and can run on any thread.
+ */
+class HintSearch
+{
+public:
+    explicit HintSearch(const HintOptions& options = HintOptions())
+        : _options(options), _cancelled(nullptr), _nodes(0), _aborted(false), _timedOut(false)
+    {
+    }
+
+    HintSearch(const HintSearch&) = delete;
+    HintSearch& operator=(const HintSearch&) = delete;
+
+    /**
+     * Take a snapshot of the game to search from
+     * @param gameModel Game model, left unchanged
+     * @return False if the game holds more cards than compact states support
+     */
+    bool prepare(const GameModel& gameModel)
+    {
+        if (!CompactGameState::fromGameModel(gameModel, _cards, _root)) {
+            CCLOG("HintSearch: too many cards or a card without a face for a hint");
+            return false;
+        }
+        _moveGenerator.setup(_cards, _options.wrapAround);
+        return true;
+    }
+
+    /**
+     * Search the snapshot
+     * @param cancelled Set by another thread to stop the search early, may be nullptr
+     * @return The best move found
+     */
+    HintResult search(const std::atomic<bool>* cancelled = nullptr)
+    {
+        _cancelled = cancelled;
+        _nodes = 0;
+        _aborted = false;
+        _timedOut = false;
+        _deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_options.budgetMs);
+
+        HintResult result;
+        for (int depth = 1; depth <= _options.maxDepth; ++depth) {
+            HintResult pass;
+            if (!searchRoot(depth, pass)) {
+                break; // Keep the last completed depth
+            }
+            result = pass;
+            if (!result.found || result.score >= kWinScore) {
+                break; // Nothing to play, or a clear is already in reach
+            }
+        }
+
+        result.nodes = _nodes;
+        result.timedOut = _timedOut;
+        result.cancelled = _cancelled && _cancelled->load();
+        CCLOG("HintSearch: found=%d card=%d depth=%d score=%d nodes=%llu", (int)result.found, result.move.cardId,
+            result.depth, result.score, (unsigned long long)result.nodes);
+        return result;
+    }
+
+private:
+    static const int kWinScore = 1000000;
+    static const int kLossScore = -1000000;
+    static const uint64_t kClockCheckInterval = 1024; // Nodes between budget checks
+
+    // Score of every root move at one depth; false if stopped before it finished
+    bool searchRoot(int depth, HintResult& result)
+    {
+        LegalMoves moves = _moveGenerator.generate(_root);
+        int bestScore = INT_MIN;
+
+        // Matches first, so a draw has to be strictly better to be suggested
+        for (uint64_t bits = moves.matches; bits; bits &= bits - 1) {
+            uint8_t slot = static_cast<uint8_t>(GameUtils::lowestBitIndex(bits));
+            CompactGameState next = _root;
+            next.applyMatch(slot);
+            int score = evaluate(next, depth - 1, 0);
+            if (_aborted) {
+                return false;
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                setMove(result, ActionType::MATCH_CARD, slot);
+            }
+        }
+        if (moves.canDraw) {
+            CompactGameState next = _root;
+            next.applyDraw();
+            int score = evaluate(next, depth - 1, 1);
+            if (_aborted) {
+                return false;
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                setMove(result, ActionType::DRAW_CARD, next.activeCard);
+            }
+        }
+
+        result.found = bestScore != INT_MIN;
+        result.score = result.found ? bestScore : 0;
+        result.depth = depth;
+        return true;
+    }
+
+    // Best score reachable from a state within depth moves
+    int evaluate(const CompactGameState& state, int depth, int drawStreak)
+    {
+        if (state.isFieldCleared()) {
+            return kWinScore + depth; // Sooner is better
+        }
+        if (!consumeNode()) {
+            return 0;
+        }
+        if (_moveGenerator.isDeadEnd(state)) {
+            return kLossScore;
+        }
+        if (depth == 0) {
+            return scoreLeaf(state);
+        }
+
+        LegalMoves moves = _moveGenerator.generate(state);
+        int bestScore = kLossScore; // No legal move left
+        unsigned triedFaces = 0;
+        for (uint64_t bits = moves.matches; bits; bits &= bits - 1) {
+            uint8_t slot = static_cast<uint8_t>(GameUtils::lowestBitIndex(bits));
+            if (!(_cards.getBelowMask(slot) & state.fieldMask)) {
+                unsigned faceBit = 1u << _cards.getFaceType(slot);
+                if (triedFaces & faceBit) {
+                    continue; // Same value and uncovers nothing, same outcome
+                }
+                triedFaces |= faceBit;
+            }
+            CompactGameState next = state;
+            next.applyMatch(slot);
+            bestScore = std::max(bestScore, evaluate(next, depth - 1, 0));
+            if (_aborted) {
+                return 0;
+            }
+        }
+        // Drawing through the whole reserve only comes back to the same state
+        if (moves.canDraw && drawStreak < state.reserveCount) {
+            CompactGameState next = state;
+            next.applyDraw();
+            bestScore = std::max(bestScore, evaluate(next, depth - 1, drawStreak + 1));
+        }
+        return bestScore;
+    }
+
+    // Fewer cards on the field first, then more of them open to play
+    int scoreLeaf(const CompactGameState& state) const
+    {
+        int fieldCount = GameUtils::countBits(state.fieldMask);
+        int uncoveredCount = GameUtils::countBits(_cards.filterPlayable(state.fieldMask, state.fieldMask));
+        int matchable = _moveGenerator.getMatchableCards(state) ? 1 : 0;
+        return -100 * fieldCount + 10 * uncoveredCount + 3 * matchable;
+    }
+
+    bool consumeNode()
+    {
+        if (_aborted) {
+            return false;
+        }
+        if ((++_nodes % kClockCheckInterval) == 0) {
+            if (_cancelled && _cancelled->load()) {
+                _aborted = true;
+            }
+            else if (std::chrono::steady_clock::now() >= _deadline) {
+                _aborted = true;
+                _timedOut = true;
+            }
+        }
+        return !_aborted;
+    }
+
+    void setMove(HintResult& result, ActionType type, int slot) const
+    {
+        result.move.type = type;
+        result.move.cardId = _cards.getCardId(slot);
+    }
+
+    HintOptions _options;
+    CompactCardTable _cards;        // Card data of the snapshot
+    CompactGameState _root;         // State of the snapshot
+    MoveGenerator _moveGenerator;
+    const std::atomic<bool>* _cancelled;
+    std::chrono::steady_clock::time_point _deadline;
+    uint64_t _nodes;
+    bool _aborted;
+    bool _timedOut;
+};
+
+#endif // HINT_SEARCH_H
@@ -0,0 +1,305 @@
+#pragma once
+#ifndef LEVEL_GENERATOR_H
+#define LEVEL_GENERATOR_H
+
+#include "cocos2d.h"
+#include "../configs/models/LevelConfig.h"
+#include "../utils/GameRandom.h"
+#include "../utils/WorkStealingScheduler.h"
+#include "LevelSolver.h"
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+
+/**
+ * Difficulty measures of a level
+ */
+struct LevelDifficulty
+{
+    LevelDifficulty() : branchingFactor(0.0), deadEndRatio(0.0), requiredDraws(0), minMoves(0), minimal(false), score(0.0) {}
+
+    double branchingFactor; // Legal moves per state along the solution
+    double deadEndRatio;    // Share of those moves that make the level unwinnable
+    int requiredDraws;      // Draws in the shortest known solution
+    int minMoves;           // Length of the shortest known solution
+    bool minimal;           // True if the solver proved minMoves optimal
+    double score;           // Combined difficulty, 0 (trivial) to 100
+};
+
+/**
+ * A generated level and how it was found
+ */
+struct GeneratedLevel
+{
+    GeneratedLevel() : seed(0), attempts(0), valid(false) {}
+
+    /**
+     * Copy the cards into a level configuration
+     */
+    void applyTo(LevelConfig& levelConfig) const
+    {
+        levelConfig.setMainAreaCards(playfield);
+        levelConfig.setBackupAreaCards(stack);
+    }
+
+    uint64_t seed;                              // Seed the level was generated from
+    int attempts;                               // Candidates built before this one was accepted
+    bool valid;                                 // False if no candidate hit the difficulty range
+    std::vector<LevelConfig::CardItem> playfield;
+    std::vector<LevelConfig::CardItem> stack;   // Same order as the level file, the last card starts active
+    LevelDifficulty difficulty;
+    SolverStats solverStats;                    // Solver work for the accepted candidate
+};
+
+/**
+ * Generator settings
+ */
+struct LevelGeneratorOptions
+{
+    LevelGeneratorOptions()
+        : minFieldCards(8), maxFieldCards(16), minReserveCards(4), maxReserveCards(10),
+          minDifficulty(0.0), maxDifficulty(100.0), maxAttempts(32), solverNodes(20000)
+    {
+    }
+
+    int minFieldCards;     // Playfield size range, at most kLayoutColumns * kLayoutRows
+    int maxFieldCards;
+    int minReserveCards;   // Stack size range, including the initial active card
+    int maxReserveCards;
+    double minDifficulty;  // Accepted LevelDifficulty::score range
+    double maxDifficulty;
+    int maxAttempts;       // Candidates per seed before giving up
+    uint64_t solverNodes;  // Node budget for measuring one candidate
+};
+
+/**
+ * Procedural level generator
+ * Builds Playfield/Stack layouts from a seed. Each candidate is dealt by
+ * playing a random match/draw sequence forward, so it is solvable by
+ * construction; LevelSolver then confirms it, looks for a shorter solution
+ * and the solution is profiled for difficulty. Candidates outside the
+ * requested difficulty range are rejected and the next one is built from
+ * the same seed, so a seed always yields the same level.
+ *
+ * One generator is not thread safe; generateBatch runs one per worker.
+ */
+class LevelGenerator
+{
+public:
+    // Field cards are laid out on a grid of non-overlapping cells in main area coordinates
+    static const int kLayoutColumns = 5;
+    static const int kLayoutRows = 4;
+    static const int kLayoutJitter = 8; // Cells are 200x300, cards 182x282
+
+    explicit LevelGenerator(const LevelGeneratorOptions& options = LevelGeneratorOptions())
+        : _options(options), _solver(makeSolverOptions(options))
+    {
+    }
+
+    LevelGenerator(const LevelGenerator&) = delete;
+    LevelGenerator& operator=(const LevelGenerator&) = delete;
+
+    /**
+     * Generate one level
+     * @param seed Seed, the same seed and options always give the same level
+     * @param level Receives the level; on failure it holds the last candidate
+     * @return True if a candidate within the difficulty range was found
+     */
+    bool generate(uint64_t seed, GeneratedLevel& level)
+    {
+        level = GeneratedLevel();
+        level.seed = seed;
+        for (int attempt = 0; attempt < _options.maxAttempts; ++attempt) {
+            GameRandom random(seed, attempt);
+            buildCandidate(random, level);
+            level.attempts = attempt + 1;
+            if (measureCandidate(level) &&
+                level.difficulty.score >= _options.minDifficulty &&
+                level.difficulty.score <= _options.maxDifficulty) {
+                level.valid = true;
+                return true;
+            }
+        }
+        CCLOG("LevelGenerator: no level in difficulty range for seed %llu", (unsigned long long)seed);
+        return false;
+    }
+
+    /**
+     * Generate levels for consecutive seeds on several threads
+     * @param options Generator settings
+     * @param firstSeed Seed of the first level, level i uses firstSeed + i
+     * @param count Number of levels
+     * @param threads Worker threads, 0 uses every hardware thread
+     * @return Levels in seed order, check GeneratedLevel::valid
+     */
+    static std::vector<GeneratedLevel> generateBatch(const LevelGeneratorOptions& options, uint64_t firstSeed,
+        int count, int threads = 0)
+    {
+        std::vector<GeneratedLevel> levels(std::max(count, 0));
+        WorkStealingScheduler scheduler(threads);
+        std::vector<std::unique_ptr<LevelGenerator>> generators;
+        for (int i = 0; i < scheduler.getWorkerCount(); ++i) {
+            generators.push_back(std::unique_ptr<LevelGenerator>(new LevelGenerator(options)));
+        }
+        scheduler.run(levels.size(), [&](size_t index, int worker) {
+            generators[worker]->generate(firstSeed + index, levels[index]);
+        });
+        return levels;
+    }
+
+    /**
+     * Combine the measures into one 0-100 score
+     * Traps weigh most, then how much of the solution is spent drawing,
+     * then how many options the player has to weigh at each step.
+     */
+    static double scoreDifficulty(const LevelDifficulty& difficulty)
+    {
+        // Each term saturates at 1: a quarter of all moves being traps,
+        // half of the solution being draws, four options per step
+        double traps = std::min(1.0, difficulty.deadEndRatio * 4.0);
+        double drawShare = difficulty.minMoves > 0 ? static_cast<double>(difficulty.requiredDraws) / difficulty.minMoves : 0.0;
+        double draws = std::min(1.0, drawShare * 2.0);
+        double choices = std::min(1.0, std::max(0.0, (difficulty.branchingFactor - 1.0) / 3.0));
+        return 100.0 * (0.4 * traps + 0.4 * draws + 0.2 * choices);
+    }
+
+private:
+    static SolverOptions makeSolverOptions(const LevelGeneratorOptions& options)
+    {
+        SolverOptions solverOptions;
+        solverOptions.maxNodes = options.solverNodes;
+        solverOptions.transpositionTableBits = 14; // Generated levels are small
+        return solverOptions;
+    }
+
+    static LevelConfig::CardItem randomCard(GameRandom& random, int face)
+    {
+        LevelConfig::CardItem card;
+        card.cardValue = static_cast<CardFaceType>(face);
+        card.cardSuit = static_cast<CardSuitType>(random.nextInt(CST_CLUBS, CST_NUM_CARD_SUIT_TYPES - 1));
+        card.cardPosition = cocos2d::Vec2::ZERO;
+        return card;
+    }
+
+    static bool areFacesAdjacent(int a, int b)
+    {
+        return a - b == 1 || b - a == 1;
+    }
+
+    /**
+     * A face adjacent to the given one, preferring one that does not also
+     * match avoidFace, so the draw planned before it cannot be skipped
+     */
+    static int neighbourFace(GameRandom& random, int face, int avoidFace)
+    {
+        int lower = face - 1;
+        int upper = face + 1;
+        bool lowerValid = lower >= CFT_ACE && !areFacesAdjacent(lower, avoidFace);
+        bool upperValid = upper <= CFT_KING && !areFacesAdjacent(upper, avoidFace);
+        if (lowerValid != upperValid) {
+            return lowerValid ? lower : upper;
+        }
+        if (face == CFT_ACE) {
+            return CFT_TWO;
+        }
+        if (face == CFT_KING) {
+            return CFT_QUEEN;
+        }
+        return random.nextBool() ? upper : lower;
+    }
+
+    /**
+     * Deal a candidate by playing a random solution forward: every field
+     * card is dealt as a match for the active card of the moment, and draws
+     * are spread between the matches.
+     */
+    void buildCandidate(GameRandom& random, GeneratedLevel& level) const
+    {
+        int maxFieldCards = std::min(_options.maxFieldCards, kLayoutColumns * kLayoutRows);
+        int fieldCount = random.nextInt(std::max(1, _options.minFieldCards), std::max(1, maxFieldCards));
+        int reserveCount = random.nextInt(std::max(1, _options.minReserveCards), std::max(1, _options.maxReserveCards));
+        int drawCount = random.nextInt(0, reserveCount - 1);
+
+        // drawsBefore[i]: draws played right before the i-th match
+        std::vector<int> drawsBefore(fieldCount, 0);
+        for (int i = 0; i < drawCount; ++i) {
+            drawsBefore[random.nextInt(0, fieldCount - 1)]++;
+        }
+
+        LevelConfig::CardItem initialCard = randomCard(random, random.nextInt(CFT_ACE, CFT_KING));
+        std::vector<LevelConfig::CardItem> drawnCards;
+        level.playfield.clear();
+        int activeFace = initialCard.cardValue;
+        for (int i = 0; i < fieldCount; ++i) {
+            int faceBeforeDraws = drawsBefore[i] > 0 ? activeFace : CFT_NONE;
+            for (int j = 0; j < drawsBefore[i]; ++j) {
+                drawnCards.push_back(randomCard(random, random.nextInt(CFT_ACE, CFT_KING)));
+                activeFace = drawnCards.back().cardValue;
+            }
+            level.playfield.push_back(randomCard(random, neighbourFace(random, activeFace, faceBeforeDraws)));
+            activeFace = level.playfield.back().cardValue;
+        }
+
+        // The stack is drawn from its back: initial card, then the planned
+        // draws in order; cards the solution never draws sit in front
+        level.stack.clear();
+        for (int i = drawCount; i < reserveCount - 1; ++i) {
+            level.stack.push_back(randomCard(random, random.nextInt(CFT_ACE, CFT_KING)));
+        }
+        level.stack.insert(level.stack.end(), drawnCards.rbegin(), drawnCards.rend());
+        level.stack.push_back(initialCard);
+
+        // Hide the dealing order and place the cards on distinct grid cells;
+        // the jitter keeps neighbours apart, so no card covers another
+        std::vector<int> cells(kLayoutColumns * kLayoutRows);
+        for (size_t i = 0; i < cells.size(); ++i) {
+            cells[i] = static_cast<int>(i);
+        }
+        shuffle(random, level.playfield);
+        shuffle(random, cells);
+        for (int i = 0; i < fieldCount; ++i) {
+            int column = cells[i] % kLayoutColumns;
+            int row = cells[i] / kLayoutColumns;
+            level.playfield[i].cardPosition = cocos2d::Vec2(
+                140.0f + 200.0f * column + random.nextInt(-kLayoutJitter, kLayoutJitter),
+                1300.0f - 300.0f * row + random.nextInt(-kLayoutJitter, kLayoutJitter));
+        }
+    }
+
+    // Fisher-Yates; unlike std::shuffle it gives the same levels on every platform
+    template <typename T>
+    static void shuffle(GameRandom& random, std::vector<T>& items)
+    {
+        for (int i = static_cast<int>(items.size()) - 1; i > 0; --i) {
+            std::swap(items[i], items[random.nextInt(0, i)]);
+        }
+    }
+
+    // Solve and profile a candidate; false if the solver could not confirm it
+    bool measureCandidate(GeneratedLevel& level)
+    {
+        LevelConfig levelConfig;
+        level.applyTo(levelConfig);
+        SolverResult result = _solver.solveLevel(levelConfig);
+        level.solverStats = result.stats;
+        if (!result.isSolvable()) {
+            return false;
+        }
+
+        SolverPathProfile profile = _solver.profileSolution(result);
+        LevelDifficulty& difficulty = level.difficulty;
+        difficulty.branchingFactor = profile.averageBranching;
+        difficulty.deadEndRatio = profile.deadEndRatio;
+        difficulty.requiredDraws = profile.draws;
+        difficulty.minMoves = result.minMoves;
+        difficulty.minimal = result.minimal;
+        difficulty.score = scoreDifficulty(difficulty);
+        return true;
+    }
+
+    LevelGeneratorOptions _options;
+    LevelSolver _solver;
+};
+
+#endif // LEVEL_GENERATOR_H
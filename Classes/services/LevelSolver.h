@@ -0,0 +1,475 @@
+#pragma once
+#ifndef LEVEL_SOLVER_H
+#define LEVEL_SOLVER_H
+
+#include "cocos2d.h"
+#include "../models/GameModel.h"
+#include "../models/CompactGameState.h"
+#include "../configs/models/LevelConfig.h"
+#include "../utils/GameUtils.h"
+#include "GameModelFromLevelGenerator.h"
+#include "MoveGenerator.h"
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+
+/**
+ * Result of a solver run
+ */
+enum class SolverStatus
+{
+    SOLVED,            // A solution was found
+    UNSOLVABLE,        // The whole move tree was searched without a solution
+    BUDGET_EXHAUSTED,  // The node budget ran out before the search finished
+    UNSUPPORTED        // The level holds more cards than the solver state supports
+};
+
+/**
+ * One step of a solution
+ */
+struct SolverMove
+{
+    ActionType type; // MATCH_CARD or DRAW_CARD
+    int cardId;      // The matched field card, or the card drawn from the reserve
+};
+
+/**
+ * Search statistics
+ */
+struct SolverStats
+{
+    SolverStats() : nodesExpanded(0), transpositionHits(0), deadEndPrunes(0), iterations(0), elapsedMs(0.0) {}
+
+    uint64_t nodesExpanded;     // States whose moves were generated
+    uint64_t transpositionHits; // States cut off by the transposition table
+    uint64_t deadEndPrunes;     // States cut off by the rank reachability check
+    int iterations;             // Iterative deepening passes
+    double elapsedMs;           // Wall time of the whole run
+};
+
+/**
+ * Solver output
+ */
+struct SolverResult
+{
+    SolverResult() : status(SolverStatus::UNSOLVABLE), minMoves(-1), minimal(false) {}
+
+    bool isSolvable() const { return status == SolverStatus::SOLVED; }
+
+    SolverStatus status;
+    int minMoves;                     // Length of the returned solution, -1 when unsolved
+    bool minimal;                     // True if no shorter solution exists
+    std::vector<SolverMove> solution; // Moves from the initial state to a cleared field
+    SolverStats stats;
+};
+
+/**
+ * Shape of the move tree along a solution, see LevelSolver::profileSolution
+ */
+struct SolverPathProfile
+{
+    SolverPathProfile() : averageBranching(0.0), deadEndRatio(0.0), draws(0) {}
+
+    double averageBranching; // Legal moves per state along the solution
+    double deadEndRatio;     // Share of those moves that lead into a dead end
+    int draws;               // Draw moves in the solution
+};
+
+/**
+ * Solver settings
+ */
+struct SolverOptions
+{
+    SolverOptions() : findMinimumMoves(true), maxNodes(20000000), transpositionTableBits(20), wrapAround(false) {}
+
+    bool findMinimumMoves;      // Run iterative deepening once a first solution is known
+    uint64_t maxNodes;          // Node budget shared by both search phases
+    int transpositionTableBits; // The transposition table holds 2^bits entries
+    bool wrapAround;            // Kings and aces also match each other
+};
+
+/**
+ * Headless level solver
+ * Searches the full match/draw move tree of a level without any view,
+ * on CompactGameState copies.
+ * Rules follow GameController: a field card matches the active card when
+ * GameUtils::areCardsAdjacent holds and no field card lies on top of it,
+ * and both a match and a draw push the old active card to the front of the
+ * reserve, so drawing cycles forever.
+ *
+ * The search runs in two phases. A depth-first pass answers solvability,
+ * then iterative deepening bounded by the first solution finds the minimum.
+ * Both share one transposition table keyed by the state hash.
+ */
+class LevelSolver
+{
+public:
+    explicit LevelSolver(const SolverOptions& options = SolverOptions())
+        : _options(options), _aborted(false), _oddValueMask(0), _transpositionMask(0)
+    {
+    }
+
+    // The move generator points into the card table
+    LevelSolver(const LevelSolver&) = delete;
+    LevelSolver& operator=(const LevelSolver&) = delete;
+
+    /**
+     * Name of a status for reports and logs
+     */
+    static const char* getStatusName(SolverStatus status)
+    {
+        switch (status) {
+        case SolverStatus::SOLVED: return "solved";
+        case SolverStatus::UNSOLVABLE: return "unsolvable";
+        case SolverStatus::BUDGET_EXHAUSTED: return "budget_exhausted";
+        case SolverStatus::UNSUPPORTED: return "unsupported";
+        default: return "unknown";
+        }
+    }
+
+    /**
+     * Solve a level configuration
+     * @param levelConfig Level configuration
+     * @return Solver result
+     */
+    SolverResult solveLevel(const LevelConfig& levelConfig)
+    {
+        GameModelFromLevelGenerator generator;
+        GameModel* gameModel = generator.createGameModelFromLevel(levelConfig);
+        SolverResult result = solve(*gameModel);
+        delete gameModel;
+        return result;
+    }
+
+    /**
+     * Solve from the current state of a game model
+     * @param gameModel Game model, left unchanged
+     * @return Solver result
+     */
+    SolverResult solve(const GameModel& gameModel)
+    {
+        auto startTime = std::chrono::steady_clock::now();
+        SolverResult result;
+
+        CompactGameState& root = _root;
+        if (!CompactGameState::fromGameModel(gameModel, _cards, root)) {
+            CCLOG("LevelSolver: level has too many cards or a card without a face for the solver");
+            result.status = SolverStatus::UNSUPPORTED;
+            return result;
+        }
+
+        _moveGenerator.setup(_cards, _options.wrapAround);
+        _oddValueMask = 0;
+        for (int face = CFT_ACE; face < CFT_NUM_CARD_FACE_TYPES; face += 2) {
+            _oddValueMask |= _cards.getFaceMask(face);
+        }
+
+        _stats = SolverStats();
+        _aborted = false;
+        _path.clear();
+        // The table is kept between runs, so batch callers do not reallocate it per level
+        size_t tableSize = static_cast<size_t>(1) << _options.transpositionTableBits;
+        if (_transpositions.size() == tableSize) {
+            std::fill(_transpositions.begin(), _transpositions.end(), TableEntry());
+        }
+        else {
+            _transpositions.assign(tableSize, TableEntry());
+        }
+        _transpositionMask = _transpositions.size() - 1;
+
+        // Phase 1: any solution
+        if (searchAny(root, 0)) {
+            result.status = SolverStatus::SOLVED;
+            result.solution = _path;
+        }
+        else {
+            result.status = _aborted ? SolverStatus::BUDGET_EXHAUSTED : SolverStatus::UNSOLVABLE;
+        }
+
+        // Phase 2: iterative deepening below the known solution length
+        if (result.isSolvable()) {
+            result.minimal = _options.findMinimumMoves;
+            if (_options.findMinimumMoves) {
+                int knownLength = static_cast<int>(result.solution.size());
+                for (int limit = lowerBound(root); limit < knownLength; ++limit) {
+                    _stats.iterations++;
+                    _path.clear();
+                    if (searchBounded(root, 0, limit)) {
+                        result.solution = _path;
+                        break;
+                    }
+                    if (_aborted) {
+                        result.minimal = false;
+                        break;
+                    }
+                }
+            }
+            result.minMoves = static_cast<int>(result.solution.size());
+        }
+
+        _stats.elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+        result.stats = _stats;
+
+        CCLOG("LevelSolver: status=%d moves=%d nodes=%llu time=%.2fms", (int)result.status, result.minMoves,
+            (unsigned long long)_stats.nodesExpanded, _stats.elapsedMs);
+        return result;
+    }
+
+    /**
+     * Replay a solution of the last solve() call and measure the moves
+     * available at each state on the way
+     * @param result Result returned by the last solve() of this solver
+     * @return Profile, all zero if the result holds no solution
+     */
+    SolverPathProfile profileSolution(const SolverResult& result) const
+    {
+        SolverPathProfile profile;
+        if (!result.isSolvable() || result.solution.empty()) {
+            return profile;
+        }
+
+        int totalMoves = 0;
+        int deadEndMoves = 0;
+        CompactGameState state = _root;
+        for (const auto& move : result.solution) {
+            for (uint64_t bits = matchableCards(state); bits; bits &= bits - 1) {
+                CompactGameState next = state;
+                next.applyMatch(static_cast<uint8_t>(GameUtils::lowestBitIndex(bits)));
+                totalMoves++;
+                if (isDeadEnd(next)) {
+                    deadEndMoves++;
+                }
+            }
+            if (state.reserveCount > 0) {
+                CompactGameState next = state;
+                next.applyDraw();
+                totalMoves++;
+                if (isDeadEnd(next)) {
+                    deadEndMoves++;
+                }
+            }
+
+            if (move.type == ActionType::MATCH_CARD) {
+                state.applyMatch(static_cast<uint8_t>(_cards.findSlot(move.cardId)));
+            }
+            else {
+                state.applyDraw();
+                profile.draws++;
+            }
+        }
+
+        profile.averageBranching = static_cast<double>(totalMoves) / result.solution.size();
+        profile.deadEndRatio = totalMoves > 0 ? static_cast<double>(deadEndMoves) / totalMoves : 0.0;
+        return profile;
+    }
+
+private:
+    // Transposition entry: the state failed with this much depth left
+    struct TableEntry
+    {
+        TableEntry() : key(0), depth(0), streak(0) {}
+
+        uint64_t key;
+        uint16_t depth;   // Remaining depth searched, kUnlimitedDepth for a full search
+        uint8_t streak;   // Consecutive draws that led into the state
+    };
+
+    static const uint16_t kUnlimitedDepth = 0xFFFF;
+
+    // Field cards that can be matched with the active card right now
+    uint64_t matchableCards(const CompactGameState& state) const { return _moveGenerator.getMatchableCards(state); }
+
+    // Matching a field card of a value already tried leads to an equivalent
+    // state when the card uncovers nothing
+    bool isInterchangeable(const CompactGameState& state, int slot) const
+    {
+        return !(_cards.getBelowMask(slot) & state.fieldMask);
+    }
+
+    bool isDeadEnd(const CompactGameState& state) const { return _moveGenerator.isDeadEnd(state); }
+
+    // Every field card needs a match. Consecutive matches alternate odd and
+    // even values, so each run of matches between draws absorbs at most one
+    // card of parity imbalance, and a run can only start now if something matches.
+    // A king-ace wrap joins two odd values, so only the last part holds then.
+    int lowerBound(const CompactGameState& state) const
+    {
+        int fieldCount = GameUtils::countBits(state.fieldMask);
+        if (fieldCount == 0) {
+            return 0;
+        }
+        if (_options.wrapAround) {
+            return fieldCount + (matchableCards(state) ? 0 : 1);
+        }
+        int oddCount = GameUtils::countBits(state.fieldMask & _oddValueMask);
+        int imbalance = std::abs(2 * oddCount - fieldCount);
+        int draws = matchableCards(state) ? std::max(0, imbalance - 1) : std::max(1, imbalance);
+        return fieldCount + draws;
+    }
+
+    bool probeTable(uint64_t key, int depth, int streak) const
+    {
+        const TableEntry& entry = _transpositions[key & _transpositionMask];
+        return entry.key == key && entry.depth >= depth && entry.streak <= streak;
+    }
+
+    void storeTable(uint64_t key, int depth, int streak)
+    {
+        TableEntry& entry = _transpositions[key & _transpositionMask];
+        if (entry.key == key && entry.depth >= depth && entry.streak <= streak) {
+            return; // Existing entry already covers this one
+        }
+        entry.key = key;
+        entry.depth = static_cast<uint16_t>(depth);
+        entry.streak = static_cast<uint8_t>(streak);
+    }
+
+    bool consumeNode()
+    {
+        if (_stats.nodesExpanded >= _options.maxNodes) {
+            _aborted = true;
+            return false;
+        }
+        _stats.nodesExpanded++;
+        return true;
+    }
+
+    // Drawing reserveCount + 1 times in a row restores the same state
+    static bool canDraw(const CompactGameState& state, int streak)
+    {
+        return state.reserveCount > 0 && streak < state.reserveCount;
+    }
+
+    bool searchAny(const CompactGameState& state, int streak)
+    {
+        if (state.isFieldCleared()) {
+            return true;
+        }
+        if (_aborted || !consumeNode()) {
+            return false;
+        }
+
+        uint64_t key = state.getHash();
+        if (probeTable(key, kUnlimitedDepth, streak)) {
+            _stats.transpositionHits++;
+            return false;
+        }
+        if (isDeadEnd(state)) {
+            _stats.deadEndPrunes++;
+            storeTable(key, kUnlimitedDepth, 0);
+            return false;
+        }
+
+        unsigned triedFaces = 0;
+        for (uint64_t bits = matchableCards(state); bits; bits &= bits - 1) {
+            uint8_t slot = static_cast<uint8_t>(GameUtils::lowestBitIndex(bits));
+            if (isInterchangeable(state, slot)) {
+                unsigned faceBit = 1u << _cards.getFaceType(slot);
+                if (triedFaces & faceBit) {
+                    continue; // Field cards of the same value are interchangeable
+                }
+                triedFaces |= faceBit;
+            }
+            CompactGameState next = state;
+            next.applyMatch(slot);
+            _path.push_back(makeMove(ActionType::MATCH_CARD, slot));
+            if (searchAny(next, 0)) {
+                return true;
+            }
+            _path.pop_back();
+        }
+
+        if (canDraw(state, streak)) {
+            CompactGameState next = state;
+            next.applyDraw();
+            _path.push_back(makeMove(ActionType::DRAW_CARD, next.activeCard));
+            if (searchAny(next, streak + 1)) {
+                return true;
+            }
+            _path.pop_back();
+        }
+
+        if (!_aborted) {
+            storeTable(key, kUnlimitedDepth, streak);
+        }
+        return false;
+    }
+
+    bool searchBounded(const CompactGameState& state, int streak, int remaining)
+    {
+        if (state.isFieldCleared()) {
+            return true;
+        }
+        if (lowerBound(state) > remaining || _aborted || !consumeNode()) {
+            return false;
+        }
+
+        uint64_t key = state.getHash();
+        if (probeTable(key, remaining, streak)) {
+            _stats.transpositionHits++;
+            return false;
+        }
+        if (isDeadEnd(state)) {
+            _stats.deadEndPrunes++;
+            storeTable(key, kUnlimitedDepth, 0);
+            return false;
+        }
+
+        unsigned triedFaces = 0;
+        for (uint64_t bits = matchableCards(state); bits; bits &= bits - 1) {
+            uint8_t slot = static_cast<uint8_t>(GameUtils::lowestBitIndex(bits));
+            if (isInterchangeable(state, slot)) {
+                unsigned faceBit = 1u << _cards.getFaceType(slot);
+                if (triedFaces & faceBit) {
+                    continue; // Field cards of the same value are interchangeable
+                }
+                triedFaces |= faceBit;
+            }
+            CompactGameState next = state;
+            next.applyMatch(slot);
+            _path.push_back(makeMove(ActionType::MATCH_CARD, slot));
+            if (searchBounded(next, 0, remaining - 1)) {
+                return true;
+            }
+            _path.pop_back();
+        }
+
+        if (canDraw(state, streak)) {
+            CompactGameState next = state;
+            next.applyDraw();
+            _path.push_back(makeMove(ActionType::DRAW_CARD, next.activeCard));
+            if (searchBounded(next, streak + 1, remaining - 1)) {
+                return true;
+            }
+            _path.pop_back();
+        }
+
+        if (!_aborted) {
+            storeTable(key, remaining, streak);
+        }
+        return false;
+    }
+
+    SolverMove makeMove(ActionType type, int slot) const
+    {
+        SolverMove move;
+        move.type = type;
+        move.cardId = _cards.getCardId(slot);
+        return move;
+    }
+
+    SolverOptions _options;
+    SolverStats _stats;
+    bool _aborted;
+    CompactCardTable _cards;                  // Card data of the level being solved
+    CompactGameState _root;                   // Initial state of the level being solved
+    MoveGenerator _moveGenerator;             // Move tables of the level being solved
+    uint64_t _oddValueMask;                   // Slots holding A, 3, 5, ... K
+    std::vector<SolverMove> _path;            // Moves of the branch being searched
+    std::vector<TableEntry> _transpositions;  // Transposition table
+    size_t _transpositionMask;
+};
+
+#endif // LEVEL_SOLVER_H
@@ -0,0 +1,171 @@
+#pragma once
+#ifndef MOVE_GENERATOR_H
+#define MOVE_GENERATOR_H
+
+#include "../models/CardModel.h"
+#include "../models/CompactGameState.h"
+#include "../utils/GameUtils.h"
+#include <cstdint>
+
+/**
+ * Legal moves of one state
+ * Matches are a bitmask of field slots, so callers walk them with the
+ * usual lowest-bit loop.
+ */
+struct LegalMoves
+{
+    LegalMoves() : matches(0), canDraw(false) {}
+
+    int getCount() const { return GameUtils::countBits(matches) + (canDraw ? 1 : 0); }
+    bool isEmpty() const { return matches == 0 && !canDraw; }
+
+    uint64_t matches; // Field slots that can be matched onto the active card
+    bool canDraw;     // The reserve has a card to draw
+};
+
+/**
+ * Move generation over compact states
+ * For each face the slots of the neighbouring faces are ORed into one
+ * adjacency mask when a level is set up, so the field cards matching the
+ * active card are one AND with the field mask, minus the covered ones.
+ * The same rule tables answer single-card checks for GameController.
+ */
+class MoveGenerator
+{
+public:
+    MoveGenerator() : _table(nullptr), _wrapAround(false)
+    {
+        std::memset(_adjacentSlots, 0, sizeof(_adjacentSlots));
+    }
+
+    /**
+     * Faces one step away from a face
+     * @param face Face index (CFT_ACE ... CFT_KING)
+     * @param wrapAround True if a king and an ace also count as adjacent
+     * @return Bit per face index
+     */
+    static uint32_t getAdjacentFaces(int face, bool wrapAround = false)
+    {
+        if (face < CFT_ACE || face >= CFT_NUM_CARD_FACE_TYPES) {
+            return 0;
+        }
+        return getNeighbourFaces(1u << face, wrapAround);
+    }
+
+    /**
+     * Faces one step away from any face of a set
+     * @param faces Bit per face index
+     * @param wrapAround True if a king and an ace also count as adjacent
+     */
+    static uint32_t getNeighbourFaces(uint32_t faces, bool wrapAround = false)
+    {
+        uint32_t neighbours = ((faces << 1) | (faces >> 1)) & kAllFaces;
+        if (wrapAround) {
+            if (faces & (1u << CFT_ACE)) {
+                neighbours |= 1u << CFT_KING;
+            }
+            if (faces & (1u << CFT_KING)) {
+                neighbours |= 1u << CFT_ACE;
+            }
+        }
+        return neighbours;
+    }
+
+    // True if two faces can be matched onto each other
+    static bool areFacesAdjacent(CardFaceType first, CardFaceType second, bool wrapAround = false)
+    {
+        return second >= CFT_ACE && second < CFT_NUM_CARD_FACE_TYPES &&
+            (getAdjacentFaces(first, wrapAround) & (1u << second)) != 0;
+    }
+
+    /**
+     * Precompute the adjacency masks of a level
+     * @param table Card data of the level, must outlive the generator's use
+     * @param wrapAround True if a king and an ace also count as adjacent
+     */
+    void setup(const CompactCardTable& table, bool wrapAround = false)
+    {
+        _table = &table;
+        _wrapAround = wrapAround;
+        std::memset(_adjacentSlots, 0, sizeof(_adjacentSlots));
+        for (int face = CFT_ACE; face < CFT_NUM_CARD_FACE_TYPES; ++face) {
+            uint64_t slots = 0;
+            for (uint32_t faces = getAdjacentFaces(face, wrapAround); faces; faces &= faces - 1) {
+                slots |= table.getFaceMask(GameUtils::lowestBitIndex(faces));
+            }
+            _adjacentSlots[face] = slots;
+        }
+    }
+
+    bool isWrapAround() const { return _wrapAround; }
+
+    // Uncovered field slots that match the active card
+    uint64_t getMatchableCards(const CompactGameState& state) const
+    {
+        if (state.activeCard == CompactGameState::kNoCard) {
+            return 0;
+        }
+        uint64_t candidates = state.fieldMask & _adjacentSlots[_table->getFaceType(state.activeCard)];
+        return _table->filterPlayable(candidates, state.fieldMask);
+    }
+
+    /**
+     * Every legal move of a state
+     * @param state State of the level passed to setup()
+     */
+    LegalMoves generate(const CompactGameState& state) const
+    {
+        LegalMoves moves;
+        moves.matches = getMatchableCards(state);
+        moves.canDraw = state.reserveCount > 0;
+        return moves;
+    }
+
+    /**
+     * True if some field card can never be matched again
+     * A field rank is only reachable if it chains to a rank in the reserve
+     * cycle, so this also holds with occlusion.
+     */
+    bool isDeadEnd(const CompactGameState& state) const
+    {
+        uint64_t cycleMask = state.reserveMask;
+        if (state.activeCard != CompactGameState::kNoCard) {
+            cycleMask |= 1ULL << state.activeCard;
+        }
+
+        unsigned cycleRanks = 0;
+        unsigned fieldRanks = 0;
+        for (int face = CFT_ACE; face < CFT_NUM_CARD_FACE_TYPES; ++face) {
+            uint64_t faceMask = _table->getFaceMask(face);
+            if (faceMask & cycleMask) {
+                cycleRanks |= 1u << face;
+            }
+            if (faceMask & state.fieldMask) {
+                fieldRanks |= 1u << face;
+            }
+        }
+
+        // A field rank is reachable when a neighbour rank is in the cycle or is itself a reachable field rank
+        unsigned reachable = 0;
+        for (;;) {
+            unsigned sources = cycleRanks | reachable;
+            unsigned next = fieldRanks & getNeighbourFaces(sources, _wrapAround);
+            if (next == reachable) {
+                break;
+            }
+            reachable = next;
+        }
+        return (fieldRanks & ~reachable) != 0;
+    }
+
+private:
+    static const uint32_t kAllFaces = (1u << CFT_NUM_CARD_FACE_TYPES) - 1;
+
+    const CompactCardTable* _table;
+    bool _wrapAround;
+    // Slots of the faces next to each face, indexed by the packed 4-bit face;
+    // the entries past CFT_KING stay 0, so a card without a valid face matches nothing
+    uint64_t _adjacentSlots[16];
+};
+
+#endif // MOVE_GENERATOR_H
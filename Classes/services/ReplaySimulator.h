@@ -0,0 +1,326 @@
+#pragma once
+#ifndef REPLAY_SIMULATOR_H
+#define REPLAY_SIMULATOR_H
+
+#include "../models/GameModel.h"
+#include "../models/ReplayModel.h"
+#include "../managers/UndoManager.h"
+#include "../configs/models/LevelConfig.h"
+#include "GameModelFromLevelGenerator.h"
+#include "MoveGenerator.h"
+#include <vector>
+
+/**
+ * Level indices of the cards of one game
+ * Replays name cards by level index; this maps them to the card IDs of a
+ * game model and back. Games built by GameModelFromLevelGenerator use the
+ * level index as card ID, models rebuilt from other sources may not.
+ */
+class ReplayCardIndex
+{
+public:
+    ReplayCardIndex() : _fieldCount(0) {}
+
+    /**
+     * Index the cards of a game that has not been played yet
+     * Field cards come first in level order, then the stack cards in config
+     * order, whose last card starts as the active card.
+     */
+    void build(const GameModel& gameModel)
+    {
+        _cardIds.clear();
+
+        const OcclusionGraph& occlusionGraph = gameModel.getOcclusionGraph();
+        _fieldCount = static_cast<int>(gameModel.getFieldCards().size());
+        _cardIds.resize(_fieldCount);
+        for (auto card : gameModel.getFieldCards()) {
+            _cardIds[occlusionGraph.getLayer(card->getItemId())] = card->getItemId();
+        }
+        for (auto card : gameModel.getReserveCards()) {
+            _cardIds.push_back(card->getItemId());
+        }
+        if (gameModel.getActiveCard()) {
+            _cardIds.push_back(gameModel.getActiveCard()->getItemId());
+        }
+
+        _indexByCard.clear();
+        for (int i = 0; i < static_cast<int>(_cardIds.size()); ++i) {
+            int cardId = _cardIds[i];
+            if (cardId < 0) {
+                continue;
+            }
+            if (static_cast<size_t>(cardId) >= _indexByCard.size()) {
+                _indexByCard.resize(cardId + 1, -1);
+            }
+            _indexByCard[cardId] = i;
+        }
+    }
+
+    int getCardCount() const { return static_cast<int>(_cardIds.size()); }
+    int getFieldCount() const { return _fieldCount; }
+
+    // Level index of a card, -1 if unknown
+    int getIndex(int cardId) const
+    {
+        return static_cast<unsigned>(cardId) < _indexByCard.size() ? _indexByCard[cardId] : -1;
+    }
+
+    // Card ID at a level index, -1 if out of range
+    int getCardId(int index) const
+    {
+        return index >= 0 && index < static_cast<int>(_cardIds.size()) ? _cardIds[index] : -1;
+    }
+
+private:
+    int _fieldCount;
+    std::vector<int> _cardIds;               // By level index
+    std::vector<int> _indexByCard;           // By card ID, -1 for unknown IDs
+};
+
+/**
+ * Replay check outcome
+ */
+enum class ReplayStatus
+{
+    VERIFIED,       // Every input was legal and the final state hash matches
+    WRONG_LEVEL,    // The replay was recorded on another level
+    ILLEGAL_EVENT,  // An input could not have been made in the game
+    HASH_MISMATCH   // All inputs were legal but the game ended elsewhere
+};
+
+/**
+ * Result of running one replay
+ */
+struct ReplayResult
+{
+    ReplayResult() : status(ReplayStatus::VERIFIED), eventsPlayed(0), finalHash(0), cleared(false) {}
+
+    bool isVerified() const { return status == ReplayStatus::VERIFIED; }
+
+    ReplayStatus status;
+    uint32_t eventsPlayed; // Inputs played before the end or the first illegal one
+    uint64_t finalHash;    // State hash where the replay stopped
+    bool cleared;          // The field was cleared
+};
+
+/**
+ * Headless replay of recorded sessions
+ * Plays replay inputs through the same GameModel moves and the same rules
+ * as GameController, without a view. A loaded level is rewound by
+ * reverting its moves, so replays of the same level after the first one
+ * run without allocating; one simulator per thread.
+ */
+class ReplaySimulator
+{
+public:
+    ReplaySimulator() : _levelId(0), _gameModel(nullptr), _wrapAround(false) {}
+    ~ReplaySimulator() { delete _gameModel; }
+
+    ReplaySimulator(const ReplaySimulator&) = delete;
+    ReplaySimulator& operator=(const ReplaySimulator&) = delete;
+
+    /**
+     * Hash of where every card is
+     * Field cards by level index, then the reserve in order and the active
+     * card. Face states are left out, the view turns the reserve top.
+     * @param gameModel Game to hash
+     * @param cardIndex Card index built when the game started
+     */
+    static uint64_t hashGameState(const GameModel& gameModel, const ReplayCardIndex& cardIndex)
+    {
+        uint64_t hash = kHashOffset;
+        const OcclusionGraph& occlusionGraph = gameModel.getOcclusionGraph();
+        for (int i = 0; i < cardIndex.getFieldCount(); ++i) {
+            if (occlusionGraph.isOnField(cardIndex.getCardId(i))) {
+                hash = hashValue(hash, static_cast<uint32_t>(i));
+            }
+        }
+        hash = hashValue(hash, kSectionMark);
+        for (auto card : gameModel.getReserveCards()) {
+            hash = hashValue(hash, static_cast<uint32_t>(cardIndex.getIndex(card->getItemId())));
+        }
+        hash = hashValue(hash, kSectionMark);
+        CardModel* activeCard = gameModel.getActiveCard();
+        return hashValue(hash, activeCard ? static_cast<uint32_t>(cardIndex.getIndex(activeCard->getItemId())) : kSectionMark);
+    }
+
+    /**
+     * True if a field card may be matched onto the active card now
+     * The card must be uncovered and one face away from the active card.
+     * @param gameModel Game to check
+     * @param cardId The field card
+     * @param wrapAround True if a king and an ace also count as adjacent
+     */
+    static bool canMatch(const GameModel& gameModel, int cardId, bool wrapAround = false)
+    {
+        CardModel* card = gameModel.getCardById(cardId);
+        CardModel* activeCard = gameModel.getActiveCard();
+        return card && activeCard && gameModel.isCardPlayable(cardId) &&
+            MoveGenerator::areFacesAdjacent(card->getFaceType(), activeCard->getFaceType(), wrapAround);
+    }
+
+    /**
+     * Set up a level to replay
+     * @param levelId Level ID, checked against the replays
+     * @param levelConfig Level configuration
+     * @return False if the game model could not be built
+     */
+    bool load(int levelId, const LevelConfig& levelConfig)
+    {
+        delete _gameModel;
+        GameModelFromLevelGenerator levelGenerator;
+        _gameModel = levelGenerator.createGameModelFromLevel(levelConfig);
+        if (!_gameModel) {
+            return false;
+        }
+        _levelId = levelId;
+        _cardIndex.build(*_gameModel);
+        _history.setup();
+        return true;
+    }
+
+    bool isLoaded() const { return _gameModel != nullptr; }
+    int getLevelId() const { return _levelId; }
+
+    // Kings and aces also match each other
+    void setWrapAround(bool wrapAround) { _wrapAround = wrapAround; }
+
+    /**
+     * Back to the start of the level
+     */
+    void rewind()
+    {
+        if (!_gameModel) {
+            return;
+        }
+        while (_history.hasUndoableActions()) {
+            _gameModel->revertMove(*_history.popUndoRecord());
+        }
+        _history.reset();
+    }
+
+    /**
+     * Play one input
+     * @return False if the input is not legal now, the game is left unchanged
+     */
+    bool play(const ReplayEvent& event)
+    {
+        switch (event.getType()) {
+        case ReplayEventType::MATCH: {
+            int cardId = _cardIndex.getCardId(event.getCardIndex());
+            if (!canMatch(*_gameModel, cardId, _wrapAround)) {
+                return false;
+            }
+            MoveRecord move = MoveRecord::match(cardId);
+            if (!_gameModel->applyMove(move)) {
+                return false;
+            }
+            _history.addUndoRecord(move);
+            return true;
+        }
+        case ReplayEventType::DRAW: {
+            MoveRecord move = MoveRecord::draw();
+            if (!_gameModel->applyMove(move)) {
+                return false;
+            }
+            _history.addUndoRecord(move);
+            return true;
+        }
+        case ReplayEventType::UNDO: {
+            const MoveRecord* move = _history.popUndoRecord();
+            if (!move) {
+                return false;
+            }
+            if (!_gameModel->revertMove(*move)) {
+                _history.cancelUndo();
+                return false;
+            }
+            return true;
+        }
+        case ReplayEventType::REDO: {
+            const MoveRecord* record = _history.popRedoRecord();
+            if (!record) {
+                return false;
+            }
+            MoveRecord move = *record;
+            if (!_gameModel->applyMove(move)) {
+                _history.cancelRedo();
+                return false;
+            }
+            return true;
+        }
+        }
+        return false;
+    }
+
+    /**
+     * Replay a recorded session from the start of the level
+     * The game is left where the replay stopped.
+     * @param replay Recorded session of the loaded level
+     */
+    ReplayResult run(const ReplayModel& replay)
+    {
+        ReplayResult result;
+        if (!_gameModel || replay.getLevelId() != _levelId) {
+            result.status = ReplayStatus::WRONG_LEVEL;
+            return result;
+        }
+
+        rewind();
+        for (const ReplayEvent& event : replay.getEvents()) {
+            if (!play(event)) {
+                result.status = ReplayStatus::ILLEGAL_EVENT;
+                break;
+            }
+            result.eventsPlayed++;
+        }
+
+        result.finalHash = getStateHash();
+        result.cleared = _gameModel->getFieldCards().empty();
+        if (result.isVerified() && result.finalHash != replay.getFinalHash()) {
+            result.status = ReplayStatus::HASH_MISMATCH;
+        }
+        return result;
+    }
+
+    uint64_t getStateHash() const { return hashGameState(*_gameModel, _cardIndex); }
+
+    const GameModel* getGameModel() const { return _gameModel; }
+    const ReplayCardIndex& getCardIndex() const { return _cardIndex; }
+
+    static const char* getStatusName(ReplayStatus status)
+    {
+        switch (status) {
+        case ReplayStatus::VERIFIED:
+            return "verified";
+        case ReplayStatus::WRONG_LEVEL:
+            return "wrong_level";
+        case ReplayStatus::ILLEGAL_EVENT:
+            return "illegal_event";
+        case ReplayStatus::HASH_MISMATCH:
+            return "hash_mismatch";
+        }
+        return "unknown";
+    }
+
+private:
+    static const uint64_t kHashOffset = 14695981039346656037ULL; // 64-bit FNV-1a
+    static const uint64_t kHashPrime = 1099511628211ULL;
+    static const uint32_t kSectionMark = 0xFFFFFFFFu;
+
+    static uint64_t hashValue(uint64_t hash, uint32_t value)
+    {
+        for (int i = 0; i < 4; ++i) {
+            hash = (hash ^ ((value >> (i * 8)) & 0xFF)) * kHashPrime;
+        }
+        return hash;
+    }
+
+    int _levelId;
+    GameModel* _gameModel;
+    ReplayCardIndex _cardIndex;
+    UndoManager _history;
+    bool _wrapAround;
+};
+
+#endif // REPLAY_SIMULATOR_H
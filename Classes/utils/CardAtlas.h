@@ -0,0 +1,92 @@
+#pragma once
+#ifndef CARD_ATLAS_H
+#define CARD_ATLAS_H
+
+#include "cocos2d.h"
+#include "../models/CardModel.h"
+#include <string>
+
+/**
+ * Card face atlas
+ * The CardAtlasBuilder tool composes every card face and the card back
+ * from the loose images under res/ into one texture with a SpriteFrameCache
+ * plist. CardView draws each card as one sprite from that texture when it
+ * is loaded and falls back to composing the loose images otherwise.
+ * Both sides share the file names and the face layout defined here.
+ */
+class CardAtlas
+{
+public:
+    // Corner numbers and suit icons sit this far from the card's top corners
+    static const int kCornerInset = 25;
+
+    static std::string getPlistFile() { return "res/card_atlas.plist"; }
+    static std::string getTextureFile() { return "res/card_atlas.png"; }
+
+    // Card background, also used as the card back
+    static std::string getCardBaseFile() { return "res/card_general.png"; }
+
+    /**
+     * Loose image of a card number
+     * @param face Card face
+     * @param suit Card suit, picks the red or black set
+     * @param big True for the centre number, false for the corner one
+     */
+    static std::string getNumberFile(CardFaceType face, CardSuitType suit, bool big)
+    {
+        static const char* const faceNames[CFT_NUM_CARD_FACE_TYPES] = {
+            "A", "2", "3", "4", "5", "6", "7", "8", "9", "10", "J", "Q", "K"
+        };
+        if (face < CFT_ACE || face >= CFT_NUM_CARD_FACE_TYPES) {
+            return "";
+        }
+        std::string color = (suit == CardSuitType::CST_HEARTS || suit == CardSuitType::CST_DIAMONDS) ? "red" : "black";
+        return std::string("res/number/") + (big ? "big" : "small") + "_" + color + "_" + faceNames[face] + ".png";
+    }
+
+    // Loose image of a suit icon
+    static std::string getSuitFile(CardSuitType suit)
+    {
+        switch (suit) {
+        case CardSuitType::CST_CLUBS: return "res/suits/club.png";
+        case CardSuitType::CST_DIAMONDS: return "res/suits/diamond.png";
+        case CardSuitType::CST_HEARTS: return "res/suits/heart.png";
+        case CardSuitType::CST_SPADES: return "res/suits/spade.png";
+        default: return "";
+        }
+    }
+
+    // Sprite frame names inside the atlas
+    static std::string getFaceFrameName(CardFaceType face, CardSuitType suit)
+    {
+        return cocos2d::StringUtils::format("card_%d_%d.png", static_cast<int>(suit), static_cast<int>(face));
+    }
+
+    static std::string getBackFrameName() { return "card_back.png"; }
+
+    /**
+     * Add the atlas frames to SpriteFrameCache if the atlas was built
+     * Needs the GL context, call it from the main thread.
+     * @return True if the atlas is loaded
+     */
+    static bool load()
+    {
+        cocos2d::SpriteFrameCache* frameCache = cocos2d::SpriteFrameCache::getInstance();
+        if (frameCache->isSpriteFramesWithFileLoaded(getPlistFile())) {
+            return true;
+        }
+        if (!cocos2d::FileUtils::getInstance()->isFileExist(getPlistFile())) {
+            CCLOG("CardAtlas: %s not found, composing cards from loose images", getPlistFile().c_str());
+            return false;
+        }
+        frameCache->addSpriteFramesWithFile(getPlistFile());
+        return isLoaded();
+    }
+
+    static bool isLoaded()
+    {
+        return cocos2d::SpriteFrameCache::getInstance()->isSpriteFramesWithFileLoaded(getPlistFile());
+    }
+};
+
+#endif // CARD_ATLAS_H
@@ -0,0 +1,158 @@
+#pragma once
+#ifndef CARD_RESOURCE_TABLE_H
+#define CARD_RESOURCE_TABLE_H
+
+#include "cocos2d.h"
+#include "../models/CardModel.h"
+#include "CardAtlas.h"
+
+/**
+ * Card images resolved to engine handles
+ * Every file and frame name is looked up once in load(); afterwards a card
+ * image is an array index computed from (face, suit), with no string
+ * building or cache lookups on the display path. Handles are retained, so
+ * a texture cache purge cannot pull them from under the views.
+ */
+class CardResourceTable
+{
+public:
+    static const int kCardCount = CFT_NUM_CARD_FACE_TYPES * CST_NUM_CARD_SUIT_TYPES;
+
+    static constexpr bool isValidCard(CardFaceType face, CardSuitType suit)
+    {
+        return face >= CFT_ACE && face < CFT_NUM_CARD_FACE_TYPES && suit >= CST_CLUBS && suit < CST_NUM_CARD_SUIT_TYPES;
+    }
+
+    // Table slot of a card, suits in blocks of 13 faces
+    static constexpr int getCardIndex(CardFaceType face, CardSuitType suit)
+    {
+        return static_cast<int>(suit) * CFT_NUM_CARD_FACE_TYPES + static_cast<int>(face);
+    }
+
+    static CardResourceTable& getInstance()
+    {
+        static CardResourceTable instance;
+        return instance;
+    }
+
+    /**
+     * Resolve every card image, including the atlas when it was built
+     * Needs the GL context, call it from the main thread at level load.
+     * Does nothing when already loaded.
+     * @return True if the card base image was found
+     */
+    bool load()
+    {
+        if (_loaded) {
+            return true;
+        }
+
+        cocos2d::TextureCache* textureCache = cocos2d::Director::getInstance()->getTextureCache();
+        cocos2d::SpriteFrameCache* frameCache = cocos2d::SpriteFrameCache::getInstance();
+        bool atlasLoaded = CardAtlas::load();
+
+        _baseTexture = retained(textureCache->addImage(CardAtlas::getCardBaseFile()));
+        if (atlasLoaded) {
+            _backFrame = retained(frameCache->getSpriteFrameByName(CardAtlas::getBackFrameName()));
+        }
+        for (int suit = CST_CLUBS; suit < CST_NUM_CARD_SUIT_TYPES; ++suit) {
+            CardSuitType cardSuit = static_cast<CardSuitType>(suit);
+            _suitTextures[suit] = retained(textureCache->addImage(CardAtlas::getSuitFile(cardSuit)));
+            for (int face = CFT_ACE; face < CFT_NUM_CARD_FACE_TYPES; ++face) {
+                CardFaceType cardFace = static_cast<CardFaceType>(face);
+                CardImages& images = _cards[getCardIndex(cardFace, cardSuit)];
+                images.bigNumber = retained(textureCache->addImage(CardAtlas::getNumberFile(cardFace, cardSuit, true)));
+                images.smallNumber = retained(textureCache->addImage(CardAtlas::getNumberFile(cardFace, cardSuit, false)));
+                if (atlasLoaded) {
+                    images.faceFrame = retained(frameCache->getSpriteFrameByName(CardAtlas::getFaceFrameName(cardFace, cardSuit)));
+                }
+            }
+        }
+
+        _loaded = true;
+        CCLOG("CardResourceTable: Loaded %d cards (atlas %s)", kCardCount, atlasLoaded ? "on" : "off");
+        return _baseTexture != nullptr;
+    }
+
+    // Release every handle, e.g. before the caches are purged on purpose
+    void unload()
+    {
+        CC_SAFE_RELEASE_NULL(_baseTexture);
+        CC_SAFE_RELEASE_NULL(_backFrame);
+        for (int suit = 0; suit < CST_NUM_CARD_SUIT_TYPES; ++suit) {
+            CC_SAFE_RELEASE_NULL(_suitTextures[suit]);
+        }
+        for (int i = 0; i < kCardCount; ++i) {
+            CC_SAFE_RELEASE_NULL(_cards[i].faceFrame);
+            CC_SAFE_RELEASE_NULL(_cards[i].bigNumber);
+            CC_SAFE_RELEASE_NULL(_cards[i].smallNumber);
+        }
+        _loaded = false;
+    }
+
+    bool isLoaded() const { return _loaded; }
+
+    // True if whole cards come from the prebaked atlas
+    bool hasAtlas() const { return _backFrame != nullptr; }
+
+    // Card background, nullptr if missing
+    cocos2d::Texture2D* getBaseTexture() const { return _baseTexture; }
+
+    // Atlas frames, nullptr without the atlas or for invalid cards
+    cocos2d::SpriteFrame* getBackFrame() const { return _backFrame; }
+    cocos2d::SpriteFrame* getFaceFrame(CardFaceType face, CardSuitType suit) const
+    {
+        return isValidCard(face, suit) ? _cards[getCardIndex(face, suit)].faceFrame : nullptr;
+    }
+
+    // Loose images for composing a card, nullptr for invalid cards or missing files
+    cocos2d::Texture2D* getNumberTexture(CardFaceType face, CardSuitType suit, bool big) const
+    {
+        if (!isValidCard(face, suit)) {
+            return nullptr;
+        }
+        const CardImages& images = _cards[getCardIndex(face, suit)];
+        return big ? images.bigNumber : images.smallNumber;
+    }
+
+    cocos2d::Texture2D* getSuitTexture(CardSuitType suit) const
+    {
+        return (suit >= CST_CLUBS && suit < CST_NUM_CARD_SUIT_TYPES) ? _suitTextures[suit] : nullptr;
+    }
+
+private:
+    struct CardImages
+    {
+        CardImages() : faceFrame(nullptr), bigNumber(nullptr), smallNumber(nullptr) {}
+
+        cocos2d::SpriteFrame* faceFrame;
+        cocos2d::Texture2D* bigNumber;
+        cocos2d::Texture2D* smallNumber;
+    };
+
+    CardResourceTable() : _loaded(false), _baseTexture(nullptr), _backFrame(nullptr)
+    {
+        std::fill(_suitTextures, _suitTextures + CST_NUM_CARD_SUIT_TYPES, nullptr);
+    }
+
+    CardResourceTable(const CardResourceTable&) = delete;
+    CardResourceTable& operator=(const CardResourceTable&) = delete;
+
+    template <typename T>
+    static T* retained(T* object)
+    {
+        CC_SAFE_RETAIN(object);
+        return object;
+    }
+
+    bool _loaded;
+    cocos2d::Texture2D* _baseTexture;
+    cocos2d::SpriteFrame* _backFrame;
+    cocos2d::Texture2D* _suitTextures[CST_NUM_CARD_SUIT_TYPES];
+    CardImages _cards[kCardCount];
+};
+
+static_assert(CardResourceTable::getCardIndex(CFT_KING, CST_SPADES) == CardResourceTable::kCardCount - 1,
+    "Card resource table index out of range");
+
+#endif // CARD_RESOURCE_TABLE_H
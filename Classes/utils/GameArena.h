@@ -0,0 +1,131 @@
+#pragma once
+#ifndef GAME_ARENA_H
+#define GAME_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+/**
+ * Allocation counters of a GameArena
+ * heapAllocations only moves when the arena grows, so a move that leaves
+ * it unchanged made no heap allocation through the arena.
+ */
+struct GameArenaStats
+{
+    GameArenaStats() : heapAllocations(0), allocations(0), bytesUsed(0), bytesReserved(0) {}
+
+    size_t heapAllocations; // Blocks taken from the heap
+    size_t allocations;     // Objects handed out
+    size_t bytesUsed;       // Bytes bumped in the blocks
+    size_t bytesReserved;   // Bytes held in blocks
+};
+
+/**
+ * Per-game bump allocator
+ * Objects are carved out of large blocks and all released together with
+ * the arena, so a game's cards and statuses cost a few heap blocks instead
+ * of one allocation each, and nothing is freed piecemeal.
+ *
+ * Destructors are not run by the arena destructor: only objects that own
+ * nothing outside the arena may live here.
+ */
+class GameArena
+{
+public:
+    static const size_t kDefaultBlockSize = 16 * 1024;
+    static const size_t kAlignment = 16; // Alignment of every allocation
+
+    explicit GameArena(size_t blockSize = kDefaultBlockSize) : _blockSize(blockSize), _offset(0) {}
+
+    ~GameArena()
+    {
+        for (auto memory : _largeBlocks) {
+            std::free(memory);
+        }
+        for (auto block : _blocks) {
+            std::free(block);
+        }
+    }
+
+    GameArena(const GameArena&) = delete;
+    GameArena& operator=(const GameArena&) = delete;
+
+    /**
+     * Allocate raw memory aligned to kAlignment
+     * @param size Size in bytes
+     * @return Memory owned by the arena, nullptr if the heap is exhausted
+     */
+    void* allocate(size_t size)
+    {
+        size = roundUp(std::max<size_t>(size, 1));
+        _stats.allocations++;
+
+        if (size > _blockSize) {
+            return allocateLarge(size);
+        }
+
+        if (_blocks.empty() || _offset + size > _blockSize) {
+            if (!nextBlock()) {
+                return nullptr;
+            }
+        }
+        void* memory = _blocks.back() + _offset;
+        _offset += size;
+        _stats.bytesUsed += size;
+        return memory;
+    }
+
+    /**
+     * Construct an object in the arena
+     * @return New object, nullptr if the heap is exhausted
+     */
+    template <typename T, typename... Args>
+    T* create(Args&&... args)
+    {
+        static_assert(alignof(T) <= kAlignment, "GameArena: alignment too large");
+        void* memory = allocate(sizeof(T));
+        return memory ? new (memory) T(std::forward<Args>(args)...) : nullptr;
+    }
+
+    const GameArenaStats& getStats() const { return _stats; }
+
+private:
+    static size_t roundUp(size_t size) { return (size + kAlignment - 1) & ~(kAlignment - 1); }
+
+    // Take a new block from the heap
+    bool nextBlock()
+    {
+        char* block = static_cast<char*>(std::malloc(_blockSize));
+        if (!block) {
+            return false;
+        }
+        _blocks.push_back(block);
+        _stats.heapAllocations++;
+        _stats.bytesReserved += _blockSize;
+        _offset = 0;
+        return true;
+    }
+
+    void* allocateLarge(size_t size)
+    {
+        void* memory = std::malloc(size);
+        if (memory) {
+            _largeBlocks.push_back(memory);
+            _stats.heapAllocations++;
+            _stats.bytesUsed += size;
+        }
+        return memory;
+    }
+
+    size_t _blockSize;
+    std::vector<char*> _blocks;       // The last one is being bumped
+    std::vector<void*> _largeBlocks;  // Oversized allocations
+    size_t _offset;                   // Next free byte in the last block
+    GameArenaStats _stats;
+};
+
+#endif // GAME_ARENA_H
@@ -0,0 +1,134 @@
+#pragma once
+#ifndef GAME_RANDOM_H
+#define GAME_RANDOM_H
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+
+/**
+ * Seedable random numbers for game logic
+ * A xoshiro256** generator: 32 bytes of state, a handful of shifts and
+ * multiplies per number, and the same sequence for a seed on every
+ * platform, unlike the std distributions. An object is not shared between
+ * threads; parallel jobs each take their own stream of one seed, which is
+ * decorrelated from the other streams by splitmix64, so results do not
+ * depend on how jobs are spread over threads.
+ *
+ * Use this instead of cocos2d::random(), whose single engine is shared by
+ * every caller and cannot be seeded per game.
+ */
+class GameRandom
+{
+public:
+    typedef uint64_t result_type;
+
+    /**
+     * @param seed Seed, e.g. the seed of a game
+     * @param stream Stream of the seed, e.g. the index of a parallel job
+     */
+    explicit GameRandom(uint64_t seed = 0, uint64_t stream = 0) { setSeed(seed, stream); }
+
+    // Restart the sequence of a seed and stream
+    void setSeed(uint64_t seed, uint64_t stream = 0)
+    {
+        uint64_t mixed = mixSeed(seed, stream);
+        for (int i = 0; i < 4; ++i) {
+            mixed = splitMix(mixed);
+            _state[i] = mixed;
+        }
+    }
+
+    uint64_t next()
+    {
+        uint64_t result = rotateLeft(_state[1] * 5, 7) * 9;
+        uint64_t shifted = _state[1] << 17;
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+        _state[2] ^= shifted;
+        _state[3] = rotateLeft(_state[3], 45);
+        return result;
+    }
+
+    /**
+     * Uniform integer in [0, bound)
+     * Lemire's multiply-and-shift: one multiply, and a division only on the
+     * rare draws that have to be rejected to stay unbiased.
+     * @param bound Exclusive upper bound, greater than 0
+     */
+    uint32_t nextBelow(uint32_t bound)
+    {
+        uint64_t product = static_cast<uint64_t>(static_cast<uint32_t>(next() >> 32)) * bound;
+        uint32_t low = static_cast<uint32_t>(product);
+        if (low < bound) {
+            uint32_t threshold = static_cast<uint32_t>(0u - bound) % bound;
+            while (low < threshold) {
+                product = static_cast<uint64_t>(static_cast<uint32_t>(next() >> 32)) * bound;
+                low = static_cast<uint32_t>(product);
+            }
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+
+    // Uniform integer in [lowerBound, upperBound]
+    int nextInt(int lowerBound, int upperBound)
+    {
+        if (upperBound <= lowerBound) {
+            return lowerBound;
+        }
+        uint32_t range = static_cast<uint32_t>(static_cast<int64_t>(upperBound) - lowerBound + 1);
+        if (range == 0) {
+            return static_cast<int>(static_cast<uint32_t>(next() >> 32)); // The whole int range
+        }
+        return static_cast<int>(static_cast<int64_t>(lowerBound) + nextBelow(range));
+    }
+
+    // Uniform double in [0, 1)
+    double nextDouble() { return (next() >> 11) * (1.0 / 9007199254740992.0); }
+
+    bool nextBool() { return (next() >> 63) != 0; }
+
+    // Another stream of the sequence, for a job that must not repeat this one's numbers
+    GameRandom split(uint64_t stream) { return GameRandom(next(), stream); }
+
+    // Standard random engine interface, e.g. for std::shuffle
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+    result_type operator()() { return next(); }
+
+    /**
+     * Seed of stream `stream` of a seed
+     * The splitmix64 finalizer: nearby seeds and streams give unrelated values.
+     */
+    static uint64_t mixSeed(uint64_t seed, uint64_t stream)
+    {
+        return splitMix(seed + 0x9E3779B97F4A7C15ULL * stream);
+    }
+
+    // A fresh seed for a new game
+    static uint32_t makeSeed()
+    {
+        std::random_device device;
+        uint64_t time = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        uint64_t mixed = mixSeed(device(), time);
+        return static_cast<uint32_t>(mixed ^ (mixed >> 32));
+    }
+
+private:
+    static uint64_t splitMix(uint64_t value)
+    {
+        uint64_t z = value + 0x9E3779B97F4A7C15ULL;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    static uint64_t rotateLeft(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+    uint64_t _state[4];
+};
+
+#endif // GAME_RANDOM_H
@@ -3,11 +3,13 @@
 #define GAME_UTILS_H
 
 #include "cocos2d.h"
+#include <cstdint>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 USING_NS_CC;
 
-static int g_cardIdentifier = 1;
-
 /**
  * Ϸ
  * ṩͨõĹߺ
@@ -15,27 +17,48 @@ static int g_cardIdentifier = 1;
 class GameUtils {
 public:
     /**
-     * һصĿƬʶ
+     * жſƬĵǷ1
      */
-    static int createUniqueCardId()
+    static bool areCardsAdjacent(int firstCardValue, int secondCardValue)
     {
-        return g_cardIdentifier++;
+        return abs(firstCardValue - secondCardValue) == 1;
     }
 
     /**
-     * жſƬĵǷ1
+     * λ 1 bits Ϊ 0
      */
-    static bool areCardsAdjacent(int firstCardValue, int secondCardValue)
+    static int lowestBitIndex(uint64_t bits)
     {
-        return abs(firstCardValue - secondCardValue) == 1;
+#if defined(_MSC_VER) && defined(_WIN64)
+        unsigned long index;
+        _BitScanForward64(&index, bits);
+        return static_cast<int>(index);
+#elif defined(_MSC_VER)
+        unsigned long index;
+        if (_BitScanForward(&index, static_cast<unsigned long>(bits))) {
+            return static_cast<int>(index);
+        }
+        _BitScanForward(&index, static_cast<unsigned long>(bits >> 32));
+        return static_cast<int>(index) + 32;
+#else
+        return __builtin_ctzll(bits);
+#endif
     }
 
     /**
-     * һڸΧڵ
+     * ͳ bits  1 ĸ
      */
-    static int generateRandomInRange(int lowerBound, int upperBound)
+    static int countBits(uint64_t bits)
     {
-        return random(lowerBound, upperBound);
+#if defined(_MSC_VER)
+        int count = 0;
+        for (; bits; bits &= bits - 1) {
+            count++;
+        }
+        return count;
+#else
+        return __builtin_popcountll(bits);
+#endif
     }
 };
 
@@ -0,0 +1,151 @@
+#pragma once
+#ifndef WORK_STEALING_SCHEDULER_H
+#define WORK_STEALING_SCHEDULER_H
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Work-stealing scheduler for batches of independent tasks
+ * Tasks are indices [0, taskCount). Each worker starts with a contiguous
+ * range and takes tasks from its front; a worker that runs dry steals the
+ * back half of the fullest other range. This keeps workers busy when task
+ * costs vary by orders of magnitude, as solver runs do.
+ */
+class WorkStealingScheduler
+{
+public:
+    // Task callback: task index, worker index
+    typedef std::function<void(size_t, int)> TaskFunction;
+
+    /**
+     * @param workerCount Number of threads, 0 uses every hardware thread
+     */
+    explicit WorkStealingScheduler(int workerCount = 0)
+        : _workerCount(workerCount), _stealCount(0)
+    {
+        if (_workerCount <= 0) {
+            _workerCount = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        }
+    }
+
+    int getWorkerCount() const { return _workerCount; }
+
+    // Number of successful steals during the last run
+    size_t getStealCount() const { return _stealCount; }
+
+    /**
+     * Run every task and block until all of them finished
+     * @param taskCount Number of tasks
+     * @param task Task callback, called from worker threads
+     */
+    void run(size_t taskCount, const TaskFunction& task)
+    {
+        _stealCount = 0;
+        int workerCount = static_cast<int>(std::min<size_t>(_workerCount, std::max<size_t>(taskCount, 1)));
+
+        _queues.clear();
+        for (int i = 0; i < workerCount; ++i) {
+            std::unique_ptr<WorkerQueue> queue(new WorkerQueue());
+            queue->begin = taskCount * i / workerCount;
+            queue->end = taskCount * (i + 1) / workerCount;
+            _queues.push_back(std::move(queue));
+        }
+
+        std::vector<std::thread> threads;
+        for (int i = 1; i < workerCount; ++i) {
+            threads.push_back(std::thread(&WorkStealingScheduler::workerLoop, this, i, std::cref(task)));
+        }
+        workerLoop(0, task);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        _queues.clear();
+    }
+
+private:
+    struct WorkerQueue
+    {
+        WorkerQueue() : begin(0), end(0) {}
+
+        std::mutex mutex;
+        size_t begin; // Next task of the owner
+        size_t end;   // One past the last task; thieves take from here
+    };
+
+    void workerLoop(int workerIndex, const TaskFunction& task)
+    {
+        size_t taskIndex;
+        while (popOwnTask(workerIndex, taskIndex) || stealTasks(workerIndex, taskIndex)) {
+            task(taskIndex, workerIndex);
+        }
+    }
+
+    bool popOwnTask(int workerIndex, size_t& taskIndex)
+    {
+        WorkerQueue& queue = *_queues[workerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.begin >= queue.end) {
+            return false;
+        }
+        taskIndex = queue.begin++;
+        return true;
+    }
+
+    // Steal the back half of the fullest queue; returns its first task to run
+    bool stealTasks(int workerIndex, size_t& taskIndex)
+    {
+        for (;;) {
+            int victim = -1;
+            size_t victimSize = 0;
+            for (int i = 0; i < static_cast<int>(_queues.size()); ++i) {
+                if (i == workerIndex) {
+                    continue;
+                }
+                WorkerQueue& queue = *_queues[i];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                size_t size = queue.end - queue.begin;
+                if (queue.begin < queue.end && size > victimSize) {
+                    victim = i;
+                    victimSize = size;
+                }
+            }
+            if (victim < 0) {
+                return false; // Every queue is empty
+            }
+
+            size_t stolenBegin;
+            size_t stolenEnd;
+            {
+                WorkerQueue& queue = *_queues[victim];
+                std::lock_guard<std::mutex> lock(queue.mutex);
+                if (queue.begin >= queue.end) {
+                    continue; // Drained meanwhile, look again
+                }
+                size_t half = (queue.end - queue.begin + 1) / 2;
+                stolenEnd = queue.end;
+                stolenBegin = queue.end - half;
+                queue.end = stolenBegin;
+            }
+            _stealCount++;
+
+            WorkerQueue& own = *_queues[workerIndex];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            own.begin = stolenBegin + 1;
+            own.end = stolenEnd;
+            taskIndex = stolenBegin;
+            return true;
+        }
+    }
+
+    int _workerCount;
+    std::atomic<size_t> _stealCount;
+    std::vector<std::unique_ptr<WorkerQueue>> _queues;
+};
+
+#endif // WORK_STEALING_SCHEDULER_H
@@ -0,0 +1,186 @@
+#pragma once
+#ifndef CARD_HIT_INDEX_H
+#define CARD_HIT_INDEX_H
+
+#include "cocos2d.h"
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Spatial index of the card rects on the play field
+ * A uniform grid over the field bounds; each cell lists the cards whose
+ * rect overlaps it. A hit test reads one cell and keeps the card drawn
+ * last, so it costs the few cards stacked around the touch no matter how
+ * many are on the board. Cards marked untouchable still hide the cards
+ * under them, so a covered card cannot be reached through its cover.
+ */
+class CardHitIndex
+{
+public:
+    static const int kNoCard = -1;
+
+    /**
+     * @param bounds Area the grid covers, rects outside it land in edge cells
+     * @param cellSize Side of a grid cell, about half a card works well
+     */
+    CardHitIndex(const cocos2d::Rect& bounds = cocos2d::Rect(0, 0, 1080, 1500), float cellSize = 128.0f)
+    {
+        reset(bounds, cellSize);
+    }
+
+    void reset(const cocos2d::Rect& bounds, float cellSize)
+    {
+        _bounds = bounds;
+        _cellSize = std::max(cellSize, 1.0f);
+        _columns = std::max(1, static_cast<int>(std::ceil(bounds.size.width / _cellSize)));
+        _rows = std::max(1, static_cast<int>(std::ceil(bounds.size.height / _cellSize)));
+        clear();
+    }
+
+    void clear()
+    {
+        _cells.assign(static_cast<size_t>(_columns) * _rows, std::vector<uint32_t>());
+        _entries.clear();
+        _freeSlots.clear();
+        _slotByCard.clear();
+    }
+
+    /**
+     * Add a card or move it to a new rect
+     * @param cardId Card ID
+     * @param rect Card rect in field coordinates
+     * @param drawOrder Higher is drawn on top
+     */
+    void insert(int cardId, const cocos2d::Rect& rect, unsigned int drawOrder)
+    {
+        bool touchable = true;
+        auto it = _slotByCard.find(cardId);
+        if (it != _slotByCard.end()) {
+            touchable = _entries[it->second].touchable;
+            remove(cardId);
+        }
+
+        uint32_t slot;
+        if (!_freeSlots.empty()) {
+            slot = _freeSlots.back();
+            _freeSlots.pop_back();
+        }
+        else {
+            slot = static_cast<uint32_t>(_entries.size());
+            _entries.push_back(Entry());
+        }
+        Entry& entry = _entries[slot];
+        entry.cardId = cardId;
+        entry.rect = rect;
+        entry.drawOrder = drawOrder;
+        entry.touchable = touchable;
+        entry.active = true;
+        _slotByCard[cardId] = slot;
+
+        forEachCell(rect, [slot](std::vector<uint32_t>& cell) { cell.push_back(slot); });
+    }
+
+    // Remove a card; unknown IDs are ignored
+    void remove(int cardId)
+    {
+        auto it = _slotByCard.find(cardId);
+        if (it == _slotByCard.end()) {
+            return;
+        }
+        uint32_t slot = it->second;
+        forEachCell(_entries[slot].rect, [slot](std::vector<uint32_t>& cell) {
+            auto found = std::find(cell.begin(), cell.end(), slot);
+            if (found != cell.end()) {
+                *found = cell.back();
+                cell.pop_back();
+            }
+        });
+        _entries[slot].active = false;
+        _freeSlots.push_back(slot);
+        _slotByCard.erase(it);
+    }
+
+    bool contains(int cardId) const { return _slotByCard.count(cardId) != 0; }
+
+    // Untouchable cards are skipped by hitTest() but keep covering what is below
+    void setTouchable(int cardId, bool touchable)
+    {
+        auto it = _slotByCard.find(cardId);
+        if (it != _slotByCard.end()) {
+            _entries[it->second].touchable = touchable;
+        }
+    }
+
+    /**
+     * Find the card drawn on top at a point
+     * @param point Point in field coordinates
+     * @return Its ID, or kNoCard if there is none or it is untouchable
+     */
+    int hitTest(const cocos2d::Vec2& point) const
+    {
+        const std::vector<uint32_t>& cell = _cells[getCellIndex(getColumn(point.x), getRow(point.y))];
+        const Entry* top = nullptr;
+        for (uint32_t slot : cell) {
+            const Entry& entry = _entries[slot];
+            if ((!top || entry.drawOrder > top->drawOrder) && entry.rect.containsPoint(point)) {
+                top = &entry;
+            }
+        }
+        return (top && top->touchable) ? top->cardId : kNoCard;
+    }
+
+    size_t size() const { return _slotByCard.size(); }
+
+private:
+    struct Entry
+    {
+        Entry() : cardId(kNoCard), drawOrder(0), touchable(true), active(false) {}
+
+        int cardId;
+        cocos2d::Rect rect;
+        unsigned int drawOrder;
+        bool touchable;
+        bool active;
+    };
+
+    int getColumn(float x) const
+    {
+        int column = static_cast<int>(std::floor((x - _bounds.origin.x) / _cellSize));
+        return std::min(std::max(column, 0), _columns - 1);
+    }
+
+    int getRow(float y) const
+    {
+        int row = static_cast<int>(std::floor((y - _bounds.origin.y) / _cellSize));
+        return std::min(std::max(row, 0), _rows - 1);
+    }
+
+    size_t getCellIndex(int column, int row) const { return static_cast<size_t>(row) * _columns + column; }
+
+    template <typename Function>
+    void forEachCell(const cocos2d::Rect& rect, Function function)
+    {
+        int firstColumn = getColumn(rect.getMinX());
+        int lastColumn = getColumn(rect.getMaxX());
+        int firstRow = getRow(rect.getMinY());
+        int lastRow = getRow(rect.getMaxY());
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                function(_cells[getCellIndex(column, row)]);
+            }
+        }
+    }
+
+    cocos2d::Rect _bounds;
+    float _cellSize;
+    int _columns;
+    int _rows;
+    std::vector<std::vector<uint32_t>> _cells; // Slots overlapping each cell, row-major
+    std::vector<Entry> _entries;               // Indexed by slot
+    std::vector<uint32_t> _freeSlots;
+    std::unordered_map<int, uint32_t> _slotByCard;
+};
+
+#endif // CARD_HIT_INDEX_H
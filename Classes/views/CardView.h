@@ -4,12 +4,13 @@
 
 #include "cocos2d.h"
 #include "../models/CardModel.h"
+#include "../utils/CardResourceTable.h"
 
 USING_NS_CC;
 
 /**
  * @brief ͼ
- * ſƵʾʹ¼
+ * ſƵʾ GameView ͳһм
  */
 class CardView : public cocos2d::Node
 {
@@ -36,15 +37,22 @@ public:
         }
         _sprite = nullptr;
         _frontSprite = nullptr;
+        _smallSprite = nullptr;
         _iconSprite = nullptr;
         _id = 0;
         _isFaceUp = false;
+        _displayedFace = CFT_NONE;
+        _displayedSuit = CST_NONE;
+
+        // ӾֻһΣ֮ update() ֻ滻
+        createSprites();
 
         return true;
     }
 
     /**
      * ͼʾ
+     * ֻл滻֡ɫؽӽڵ
      * @param cardModel ģ
      */
     void update(const CardModel* cardModel)
@@ -64,41 +72,47 @@ public:
         // λ
         setPosition(cardModel->getLocation());
 
-        // Ƴɵʾ
-        removeAllChildren();
-
         if (_isFaceUp) {
-            displayCardFront(cardModel);  // ؿ
+            displayCardFront(cardModel);  // ʾ
         }
         else {
-            displayCardBack();           // ؿƱ
+            displayCardBack();           // ʾƱ
         }
-
-        configureTouchHandling();
     }
 
     /**
-     * ÿƵص
-     * @param callback صΪID
+     * ǰͼ״̬ CardViewPool 
+     * ӾѼص
      */
-    void setTouchHandler(const std::function<void(int)>& callback) { _touchHandler = callback; }
+    void prepareForReuse()
+    {
+        stopAllActions();
+        setScale(1.0f);
+        setVisible(true);
+        if (_sprite) {
+            _sprite->stopAllActions(); // ʾ˸
+            _sprite->setColor(Color3B::WHITE);
+        }
+        _id = 0;
+    }
 
     /**
      * ſƶ
+     * δɵƶᱻȡƴӵǰλ÷Ŀ꣬
      * @param targetPosition Ŀλ
      * @param duration ʱ
      * @param callback ɺĻص
      */
     void playMovementEffect(const cocos2d::Vec2& targetPosition, float duration, const std::function<void()>& callback = nullptr)
     {
+        stopActionByTag(kMoveActionTag);
         auto move = MoveTo::create(duration, targetPosition);
+        Action* action = move;
         if (callback) {
-            auto sequence = Sequence::create(move, CallFunc::create(callback), nullptr);
-            runAction(sequence);
-        }
-        else {
-            runAction(move);
+            action = Sequence::create(move, CallFunc::create(callback), nullptr);
         }
+        action->setTag(kMoveActionTag);
+        runAction(action);
     }
 
     /**
@@ -121,15 +135,41 @@ public:
     }
 
     /**
-     * ÿǷɵ
-     * @param enabled Ƿɵ
+     * ðʱĸ
+     * @param highlighted Ƿ
      */
-    void setTouchable(bool enabled)
+    void setHighlighted(bool highlighted)
     {
-        _eventDispatcher->pauseEventListenersForTarget(this, !enabled);
-        CCLOG("CardView: Touch %s for card %d", enabled ? "enabled" : "disabled", _id);
+        if (_sprite) {
+            _sprite->setColor(highlighted ? Color3B(200, 200, 255) : Color3B::WHITE);
+        }
     }
 
+    /**
+     * ʾЧڰɫǳɫ֮ѭ˸
+     * @param enabled Ƿʾʾ
+     */
+    void setHintEffect(bool enabled)
+    {
+        if (!_sprite) {
+            return;
+        }
+        _sprite->stopActionByTag(kHintActionTag);
+        _sprite->setColor(Color3B::WHITE);
+        if (enabled) {
+            auto blink = Sequence::create(TintTo::create(0.4f, 255, 240, 140), TintTo::create(0.4f, 255, 255, 255), nullptr);
+            auto repeat = RepeatForever::create(blink);
+            repeat->setTag(kHintActionTag);
+            _sprite->runAction(repeat);
+        }
+    }
+
+    /**
+     * ȡƳߴ磨δţм
+     * ƾͼλΪ
+     */
+    cocos2d::Size getCardSize() const { return _sprite ? _sprite->getContentSize() : cocos2d::Size::ZERO; }
+
     /**
      * ÿǷ񷭿
      * @param flipped Ƿ񷭿
@@ -137,98 +177,119 @@ public:
     void setFaceUp(bool flipped) { _isFaceUp = flipped; }
 
 private:
-    // ؿƱ
-    void displayCardBack()
+    static const int kHintActionTag = 0x4B1; // ʾ˸ıǩ
+    static const int kMoveActionTag = 0x4B2; // ƶıǩ
+
+    // ƾ
+    // ͼѼʱֻһ飻ɵͼ֡ɫϣԪĬ
+    // ͼƬ CardResourceTableڹؿʱȵ load()
+    void createSprites()
     {
-        _sprite = Sprite::create("res/card_general.png");
+        const CardResourceTable& resources = CardResourceTable::getInstance();
+        if (resources.hasAtlas()) {
+            _sprite = Sprite::createWithSpriteFrame(resources.getBackFrame());
+            if (_sprite) {
+                addChild(_sprite);
+                return;
+            }
+        }
+
+        _sprite = resources.getBaseTexture() ? Sprite::createWithTexture(resources.getBaseTexture()) : nullptr;
         if (!_sprite) {
             _sprite = createFallbackCardSprite();
         }
         addChild(_sprite);
+
+        const Size& cardSize = _sprite->getContentSize();
+        const float inset = static_cast<float>(CardAtlas::kCornerInset);
+
+        _frontSprite = Sprite::create();
+        _frontSprite->setPosition(Vec2(cardSize.width / 2, cardSize.height / 2));
+        _sprite->addChild(_frontSprite);
+
+        _smallSprite = Sprite::create();
+        _smallSprite->setPosition(Vec2(inset, cardSize.height - inset));
+        _sprite->addChild(_smallSprite);
+
+        _iconSprite = Sprite::create();
+        _iconSprite->setPosition(Vec2(cardSize.width - inset, cardSize.height - inset));
+        _sprite->addChild(_iconSprite);
+
+        setFaceElementsVisible(false);
     }
 
-    // ؿ
-    void displayCardFront(const CardModel* cardModel)
+    // ǷʹͼԤȺϳɵ
+    bool usesAtlas() const { return _frontSprite == nullptr; }
+
+    // ʾƱ
+    void displayCardBack()
     {
-        _sprite = Sprite::create("res/card_general.png");
-        if (!_sprite) {
-            _sprite = createFallbackCardSprite();
+        if (usesAtlas()) {
+            setAtlasFrame(CardResourceTable::getInstance().getBackFrame());
+            _displayedFace = CFT_NONE;
+            _displayedSuit = CST_NONE;
+            return;
         }
-        addChild(_sprite);
+        setFaceElementsVisible(false);
+    }
 
+    // ʾ
+    void displayCardFront(const CardModel* cardModel)
+    {
         // ֺͻɫ
         displayFaceAndSuit(cardModel);
+        if (!usesAtlas()) {
+            setFaceElementsVisible(true);
+        }
     }
 
-    // ؿֺͻɫ
+    // ؿֺͻɫϴʾͬʱ
     void displayFaceAndSuit(const CardModel* cardModel)
     {
-        int value = cardModel->getCardValue();
+        CardFaceType face = cardModel->getFaceType();
         CardSuitType suit = cardModel->getSuitType();
-
-        // ش
-        displayBigNumber(value, suit);
-        // С
-        displaySmallNumber(value, suit);
-        // ػɫ
-        displaySuitIcon(suit);
-    }
-
-    // ش
-    void displayBigNumber(int value, CardSuitType suit)
-    {
-        std::string filename = getFaceFilename(value, suit, "big");
-        _frontSprite = Sprite::create(filename);
-        if (_frontSprite) {
-            _frontSprite->setPosition(Vec2(_sprite->getContentSize().width / 2, _sprite->getContentSize().height / 2));
-            _sprite->addChild(_frontSprite);
+        if (face == _displayedFace && suit == _displayedSuit) {
+            return;
         }
-    }
+        _displayedFace = face;
+        _displayedSuit = suit;
 
-    // С
-    void displaySmallNumber(int value, CardSuitType suit)
-    {
-        std::string filename = getFaceFilename(value, suit, "small");
-        auto smallSprite = Sprite::create(filename);
-        if (smallSprite) {
-            smallSprite->setPosition(Vec2(25, _sprite->getContentSize().height - 25));
-            _sprite->addChild(smallSprite);
+        //  (ֵ, ɫ) ֱӲƴַ
+        const CardResourceTable& resources = CardResourceTable::getInstance();
+        if (usesAtlas()) {
+            setAtlasFrame(resources.getFaceFrame(face, suit)); // 
+            return;
         }
+        setSpriteTexture(_frontSprite, resources.getNumberTexture(face, suit, true));  // 
+        setSpriteTexture(_smallSprite, resources.getNumberTexture(face, suit, false)); // С
+        setSpriteTexture(_iconSprite, resources.getSuitTexture(suit));                 // ɫ
     }
 
-    // ػɫͼ
-    void displaySuitIcon(CardSuitType suit)
+    // 滻СʾȱʧͼƬʾ
+    void setSpriteTexture(cocos2d::Sprite* sprite, cocos2d::Texture2D* texture)
     {
-        std::string filename = getSuitFilename(suit);
-        _iconSprite = Sprite::create(filename);
-        if (_iconSprite) {
-            _iconSprite->setPosition(Vec2(_sprite->getContentSize().width - 25, _sprite->getContentSize().height - 25));
-            _sprite->addChild(_iconSprite);
+        if (texture) {
+            sprite->setTexture(texture);
+            sprite->setTextureRect(Rect(Vec2::ZERO, texture->getContentSize()));
+        }
+        else {
+            sprite->setTextureRect(Rect::ZERO);
         }
     }
 
-    // ȡļ·
-    std::string getFaceFilename(int value, CardSuitType suit, const std::string& size)
+    // лͼ֡ͼûеƣЧֵԭ
+    void setAtlasFrame(cocos2d::SpriteFrame* frame)
     {
-        std::string color = (suit == CardSuitType::CST_HEARTS || suit == CardSuitType::CST_DIAMONDS) ? "red" : "black";
-        std::string name = (value == 1) ? "A" :
-            (value == 11) ? "J" :
-            (value == 12) ? "Q" :
-            (value == 13) ? "K" : std::to_string(value);
-
-        return "res/number/" + size + "_" + color + "_" + name + ".png";
+        if (frame) {
+            _sprite->setSpriteFrame(frame);
+        }
     }
 
-    // ȡɫͼļ·
-    std::string getSuitFilename(CardSuitType suit)
+    void setFaceElementsVisible(bool visible)
     {
-        switch (suit) {
-        case CardSuitType::CST_CLUBS: return "res/suits/club.png";
-        case CardSuitType::CST_DIAMONDS: return "res/suits/diamond.png";
-        case CardSuitType::CST_HEARTS: return "res/suits/heart.png";
-        case CardSuitType::CST_SPADES: return "res/suits/spade.png";
-        default: return "";
-        }
+        _frontSprite->setVisible(visible);
+        _smallSprite->setVisible(visible);
+        _iconSprite->setVisible(visible);
     }
 
     // ĬϿƾ飨ȱʧԴʱ
@@ -243,46 +304,14 @@ private:
         return sprite;
     }
 
-    // 
-    void configureTouchHandling()
-    {
-        _eventDispatcher->removeEventListenersForTarget(this);
-
-        auto listener = EventListenerTouchOneByOne::create();
-        listener->setSwallowTouches(true);
-
-        listener->onTouchBegan = [this](Touch* touch, Event* event) -> bool {
-            if (!_sprite || !isVisible()) return false;
-            Vec2 locationInNode = convertToNodeSpace(touch->getLocation());
-            Size s = _sprite->getContentSize();
-            Rect rect = Rect(0, 0, s.width, s.height);
-            if (rect.containsPoint(locationInNode)) {
-                _sprite->setColor(Color3B(200, 200, 255));
-                return true;
-            }
-            return false;
-            };
-
-        listener->onTouchEnded = [this](Touch* touch, Event* event) {
-            _sprite->setColor(Color3B::WHITE);
-            if (_touchHandler) {
-                _touchHandler(_id);
-            }
-            };
-
-        listener->onTouchCancelled = [this](Touch* touch, Event* event) {
-            _sprite->setColor(Color3B::WHITE);
-            };
-
-        _eventDispatcher->addEventListenerWithSceneGraphPriority(listener, this);
-    }
-
     cocos2d::Sprite* _sprite; // ƾ
     cocos2d::Sprite* _frontSprite; // ־
+    cocos2d::Sprite* _smallSprite; // С־
     cocos2d::Sprite* _iconSprite; // ɫ
-    std::function<void(int)> _touchHandler; // ص
     int _id; // ID
     bool _isFaceUp; // Ƿ񷭿
+    CardFaceType _displayedFace; // ǰӦֵ
+    CardSuitType _displayedSuit; // ǰӦĻɫ
 };
 
 #endif // CARD_VIEW_H
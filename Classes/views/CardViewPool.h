@@ -0,0 +1,93 @@
+#pragma once
+#ifndef CARD_VIEW_POOL_H
+#define CARD_VIEW_POOL_H
+
+#include "cocos2d.h"
+#include "CardView.h"
+
+/**
+ * Pool of detached card views
+ * Released views keep their child sprites and loaded textures, so reusing
+ * one only swaps textures and position. Views are retained while pooled
+ * and freed with the pool.
+ */
+class CardViewPool
+{
+public:
+    CardViewPool() : _hitCount(0), _missCount(0), _releaseCount(0) {}
+
+    /**
+     * Take a view from the pool, or create one if it is empty
+     * @return Detached view, nullptr if creation failed
+     */
+    CardView* acquire()
+    {
+        if (!_freeViews.empty()) {
+            CardView* cardView = _freeViews.back();
+            cardView->retain(); // Keep it alive past popBack()
+            _freeViews.popBack();
+            cardView->autorelease();
+            _hitCount++;
+            return cardView;
+        }
+        _missCount++;
+        return CardView::create();
+    }
+
+    /**
+     * Detach a view from its parent and keep it for reuse
+     * @param cardView View from acquire()
+     */
+    void release(CardView* cardView)
+    {
+        if (!cardView) {
+            return;
+        }
+        _freeViews.pushBack(cardView);
+        cardView->removeFromParentAndCleanup(false); // prepareForReuse() stops the actions
+        cardView->prepareForReuse();
+        _releaseCount++;
+    }
+
+    /**
+     * Create views up front, e.g. at level load, so the first moves hit the pool
+     * @param count Number of free views to have ready
+     */
+    void prewarm(size_t count)
+    {
+        _freeViews.reserve(static_cast<ssize_t>(count));
+        while (static_cast<size_t>(_freeViews.size()) < count) {
+            CardView* cardView = CardView::create();
+            if (!cardView) {
+                CCLOG("CardViewPool: Failed to create card view");
+                return;
+            }
+            _freeViews.pushBack(cardView);
+        }
+        CCLOG("CardViewPool: Prewarmed %d card views", (int)_freeViews.size());
+    }
+
+    // Drop every pooled view
+    void clear() { _freeViews.clear(); }
+
+    size_t getFreeCount() const { return static_cast<size_t>(_freeViews.size()); }
+
+    // Acquisitions served from the pool / by creating a new view
+    size_t getHitCount() const { return _hitCount; }
+    size_t getMissCount() const { return _missCount; }
+    size_t getReleaseCount() const { return _releaseCount; }
+
+    float getHitRate() const
+    {
+        size_t total = _hitCount + _missCount;
+        return total ? static_cast<float>(_hitCount) / total : 0.0f;
+    }
+
+private:
+    cocos2d::Vector<CardView*> _freeViews;
+    size_t _hitCount;
+    size_t _missCount;
+    size_t _releaseCount;
+};
+
+#endif // CARD_VIEW_POOL_H
@@ -4,6 +4,9 @@
 
 #include "cocos2d.h"
 #include "CardView.h"
+#include "CardViewPool.h"
+#include "CardHitIndex.h"
+#include "IGameView.h"
 
 // Forward declaration
 class GameModel;
@@ -12,7 +15,7 @@ class GameModel;
  * Game UI view
  * Responsible for rendering the entire UI and handling user interactions
  */
-class GameView : public cocos2d::Node
+class GameView : public cocos2d::Node, public IGameView
 {
 public:
     // Standard cocos2d-x object creation pattern
@@ -36,97 +39,134 @@ public:
             return false;
         }
 
+        _displayGeneration = 0;
+        _pressedCardId = CardHitIndex::kNoCard;
+        _hintCardId = CardHitIndex::kNoCard;
+        _fieldTouchListener = nullptr;
+        _reserveTouchListener = nullptr;
         initializeUI();
         return true;
     }
 
     /**
      * Updates the UI based on the current game model
+     * Reconciles against what is on screen: card views are matched by card
+     * id, and only views whose area, side or position changed are touched.
+     * Views of cards that are no longer shown go back to the card view
+     * pool; new ones are taken from it.
      * @param model Game data model
      */
-    void updateDisplay(GameModel* model)
+    void updateDisplay(GameModel* model) override
     {
         if (!model) return;
 
         CCLOG("GameView: Updating display");
 
-        // Gather nodes to remove (removing card views)
-        std::vector<Node*> nodesToDelete;
+        _displayGeneration++;
 
-        for (auto child : _mainAreaNode->getChildren()) {
-            if (dynamic_cast<CardView*>(child)) {
-                nodesToDelete.push_back(child);
-            }
-        }
-
-        for (auto child : _footerNode->getChildren()) {
-            if (dynamic_cast<CardView*>(child)) {
-                nodesToDelete.push_back(child);
-            }
-        }
-
-        for (auto child : _reserveNode->getChildren()) {
-            if (dynamic_cast<CardView*>(child)) {
-                nodesToDelete.push_back(child);
-            }
-        }
-
-        // Remove all collected card views
-        for (auto node : nodesToDelete) {
-            node->removeFromParent();
-        }
-
-        // Clear current card view mapping
-        _cardViewMap.clear();
-
-        // Create cards for the main play field
+        // Cards on the main play field, stacked and clickable as the occlusion graph says
+        const OcclusionGraph& occlusionGraph = model->getOcclusionGraph();
         const auto& fieldCards = model->getFieldCards();
         for (auto card : fieldCards) {
             if (card) {
-                CardView* cardDisplay = CardView::create();
-                if (cardDisplay) {
-                    cardDisplay->update(card);
-                    cardDisplay->setTouchHandler(_cardTouchCallback);
-                    _cardViewMap[card->getItemId()] = cardDisplay;
-                    _mainAreaNode->addChild(cardDisplay);
-                }
+                int cardId = card->getItemId();
+                reconcileCardView(card, CardArea::FIELD, std::max(occlusionGraph.getLayer(cardId), 0));
+                _fieldHitIndex.setTouchable(cardId, occlusionGraph.isPlayable(cardId));
             }
         }
 
-        // Create the active card at the bottom of the screen
+        // The active card at the bottom of the screen
         CardModel* activeCard = model->getActiveCard();
         if (activeCard) {
-            CardView* cardDisplay = CardView::create();
-            if (cardDisplay) {
-                activeCard->setReversed(true);
-                cardDisplay->update(activeCard);
-                cardDisplay->setScale(1.05f);
-                _cardViewMap[activeCard->getItemId()] = cardDisplay;
-                _footerNode->addChild(cardDisplay);
-            }
+            activeCard->setReversed(true);
+            reconcileCardView(activeCard, CardArea::FOOTER);
         }
 
-        // Display the top card of the reserve stack
+        // The top card of the reserve stack
         const auto& reserveCards = model->getReserveCards();
         if (!reserveCards.empty()) {
             CardModel* topReserveCard = reserveCards.back();
             if (topReserveCard) {
-                CardView* cardDisplay = CardView::create();
-                if (cardDisplay) {
-                    topReserveCard->setReversed(false);
-                    cardDisplay->update(topReserveCard);
-                    _cardViewMap[topReserveCard->getItemId()] = cardDisplay;
-                    _reserveNode->addChild(cardDisplay);
+                topReserveCard->setReversed(false);
+                reconcileCardView(topReserveCard, CardArea::RESERVE);
+            }
+        }
+
+        // Remove views of cards that were not visited above
+        for (auto it = _cardViewMap.begin(); it != _cardViewMap.end();) {
+            if (it->second.generation != _displayGeneration) {
+                if (it->second.area == CardArea::FIELD) {
+                    _fieldHitIndex.remove(it->first);
                 }
+                _cardViewPool.release(it->second.view);
+                it = _cardViewMap.erase(it);
+            }
+            else {
+                ++it;
             }
         }
     }
 
+    /**
+     * Release every card view, e.g. before a new game is shown
+     * Card IDs start over in every game, so a view must not be matched by
+     * ID to a card of the next game: it would keep showing the old card.
+     */
+    void clearDisplay() override
+    {
+        clearHint();
+        _pressedCardId = CardHitIndex::kNoCard;
+        for (auto& entry : _cardViewMap) {
+            _cardViewPool.release(entry.second.view);
+        }
+        _cardViewMap.clear();
+        _fieldHitIndex.clear();
+    }
+
+    /**
+     * Fly a card that became the active card to the bottom position
+     * The rest of the display shows the move at once, so cards it uncovered
+     * turn over and take clicks in the same frame; only the moved card is
+     * still on its way. A card still flying from an earlier move lands
+     * straight away, so fast taps never queue up animations.
+     * @param model Game data model, already updated by the move
+     * @param cardId The new active card
+     */
+    void showCardMove(GameModel* model, int cardId) override
+    {
+        // Where the card is on screen before the display puts it at the bottom
+        CardView* cardDisplay = getCardView(cardId);
+        cocos2d::Vec2 startWorldPos;
+        if (cardDisplay) {
+            startWorldPos = cardDisplay->getParent()->convertToWorldSpace(cardDisplay->getPosition());
+        }
+
+        updateDisplay(model);
+
+        CardView* movedDisplay = getCardView(cardId);
+        if (cardDisplay && movedDisplay == cardDisplay) {
+            cocos2d::Vec2 target = cardDisplay->getPosition();
+            cardDisplay->setPosition(cardDisplay->getParent()->convertToNodeSpace(startWorldPos));
+            cardDisplay->playMovementEffect(target, kCardMoveSeconds);
+        }
+    }
+
+    cocos2d::Node* getNode() override { return this; }
+
+    /**
+     * Fill the card view pool before the first display, e.g. at level load
+     * @param count Number of card views to have ready
+     */
+    void prewarmCardViews(size_t count) { _cardViewPool.prewarm(count); }
+
+    // Pool the card views come from, for its hit/miss counters
+    const CardViewPool& getCardViewPool() const { return _cardViewPool; }
+
     /**
      * Set the card click callback
      * @param callback Function to handle card clicks, accepts card ID as an argument
      */
-    void setCardClickCallback(const std::function<void(int)>& callback) {
+    void setCardClickCallback(const std::function<void(int)>& callback) override {
         _cardTouchCallback = callback;
     }
 
@@ -134,27 +174,41 @@ public:
      * Set the reserve stack click callback
      * @param callback Function to handle stack clicks
      */
-    void setReserveClickCallback(const std::function<void()>& callback) {
+    void setReserveClickCallback(const std::function<void()>& callback) override {
         _reserveClickCallback = callback;
     }
 
     /**
-     * Play the animation for moving a card to a target position
-     * @param cardId ID of the card to move
-     * @param targetPosition Target position for the card
-     * @param duration Duration of the animation
-     * @param callback Callback to call after the animation finishes
+     * Allow or block clicks on a field card; a blocked card still hides the cards under it
+     * updateDisplay() resets this from the occlusion graph
+     * @param cardId ID of the card
+     * @param touchable Whether clicks on it reach the card click callback
      */
-    void animateCardMovement(int cardId, const cocos2d::Vec2& targetPosition,
-        float duration, const std::function<void()>& callback = nullptr)
+    void setCardTouchable(int cardId, bool touchable) { _fieldHitIndex.setTouchable(cardId, touchable); }
+
+    /**
+     * Make a card blink to suggest it as the next move
+     * Replaces the previous hint; a card without a view shows nothing.
+     * @param cardId The field card to match, or the reserve card to draw
+     */
+    void showHint(int cardId) override
     {
+        clearHint();
         CardView* cardDisplay = getCardView(cardId);
         if (cardDisplay) {
-            cardDisplay->playMovementEffect(targetPosition, duration, callback);
+            cardDisplay->setHintEffect(true);
+            _hintCardId = cardId;
         }
-        else if (callback) {
-            callback();
+    }
+
+    // Stop the hint blinking, if any
+    void clearHint() override
+    {
+        CardView* cardDisplay = getCardView(_hintCardId);
+        if (cardDisplay) {
+            cardDisplay->setHintEffect(false);
         }
+        _hintCardId = CardHitIndex::kNoCard;
     }
 
     /**
@@ -165,7 +219,7 @@ public:
     CardView* getCardView(int cardId) const
     {
         auto it = _cardViewMap.find(cardId);
-        return (it != _cardViewMap.end()) ? it->second : nullptr;
+        return (it != _cardViewMap.end()) ? it->second.view : nullptr;
     }
 
     /**
@@ -202,6 +256,132 @@ public:
     cocos2d::Node* getReserveNode() const { return _reserveNode; }
 
 private:
+    // How long a matched or drawn card takes to reach the bottom position
+    static constexpr float kCardMoveSeconds = 0.5f;
+
+    // Where a card view is shown
+    enum class CardArea
+    {
+        FIELD,   // Main play field, clickable
+        FOOTER,  // Active card
+        RESERVE  // Top of the reserve stack
+    };
+
+    // A card view and the state it was last displayed with
+    struct DisplayedCard
+    {
+        DisplayedCard() : view(nullptr), area(CardArea::FIELD), faceUp(false), generation(0), drawOrder(0) {}
+
+        CardView* view;
+        CardArea area;
+        bool faceUp;
+        unsigned int generation; // Last updateDisplay() that showed the card
+        int drawOrder;           // Local z order in its area, higher is on top
+    };
+
+    cocos2d::Node* getAreaNode(CardArea area) const
+    {
+        switch (area) {
+        case CardArea::FIELD: return _mainAreaNode;
+        case CardArea::FOOTER: return _footerNode;
+        default: return _reserveNode;
+        }
+    }
+
+    /**
+     * Show a card in an area, reusing its existing view when there is one
+     * @param card Card model
+     * @param area Area to show the card in
+     * @param drawOrder Local z order in the area, higher is on top
+     */
+    void reconcileCardView(CardModel* card, CardArea area, int drawOrder = 0)
+    {
+        int cardId = card->getItemId();
+        DisplayedCard& displayed = _cardViewMap[cardId];
+        displayed.generation = _displayGeneration;
+        displayed.drawOrder = drawOrder;
+
+        if (!displayed.view) {
+            CardView* cardDisplay = _cardViewPool.acquire();
+            if (!cardDisplay) {
+                _cardViewMap.erase(cardId);
+                return;
+            }
+            cardDisplay->update(card);
+            getAreaNode(area)->addChild(cardDisplay, drawOrder);
+            displayed.view = cardDisplay;
+            displayed.area = area;
+            displayed.faceUp = card->isReversed();
+            applyAreaSettings(displayed);
+            if (area == CardArea::FIELD) {
+                indexFieldCard(cardId, displayed);
+            }
+            return;
+        }
+
+        CardView* cardDisplay = displayed.view;
+        bool moved = false;
+
+        // A card still flying lands at once, the display shows the model as it is now
+        if (cardDisplay->getNumberOfRunningActions() > 0) {
+            cardDisplay->stopAllActions();
+        }
+
+        if (displayed.area != area) {
+            if (displayed.area == CardArea::FIELD) {
+                _fieldHitIndex.remove(cardId);
+            }
+            cardDisplay->retain();
+            cardDisplay->removeFromParentAndCleanup(false);
+            getAreaNode(area)->addChild(cardDisplay, drawOrder);
+            cardDisplay->release();
+            displayed.area = area;
+            applyAreaSettings(displayed);
+            moved = true;
+        }
+        else if (cardDisplay->getLocalZOrder() != drawOrder) {
+            cardDisplay->setLocalZOrder(drawOrder);
+            moved = true;
+        }
+
+        if (displayed.faceUp != card->isReversed()) {
+            cardDisplay->update(card); // Flip, redraws the card at its location
+            displayed.faceUp = card->isReversed();
+            moved = true;
+        }
+        else if (cardDisplay->getPosition() != card->getLocation()) {
+            cardDisplay->setPosition(card->getLocation());
+            moved = true;
+        }
+
+        if (cardDisplay->getScale() != getAreaScale(area)) {
+            cardDisplay->setScale(getAreaScale(area));
+            moved = true;
+        }
+
+        // The hit rect of a field card follows its view
+        if (area == CardArea::FIELD && moved) {
+            indexFieldCard(cardId, displayed);
+        }
+    }
+
+    // Settings that depend on the area
+    void applyAreaSettings(const DisplayedCard& displayed)
+    {
+        displayed.view->setScale(getAreaScale(displayed.area));
+    }
+
+    // Put a field card's rect, centred on the view, into the hit index
+    void indexFieldCard(int cardId, const DisplayedCard& displayed)
+    {
+        cocos2d::Size size = displayed.view->getCardSize() * displayed.view->getScale();
+        const cocos2d::Vec2& position = displayed.view->getPosition();
+        cocos2d::Rect rect(position.x - size.width / 2, position.y - size.height / 2, size.width, size.height);
+        _fieldHitIndex.insert(cardId, rect, static_cast<unsigned int>(displayed.drawOrder));
+    }
+
+    static float getAreaScale(CardArea area) { return area == CardArea::FOOTER ? 1.05f : 1.0f; }
+
     void initializeUI()
     {
         // Initialize main area, footer, and reserve nodes
@@ -242,10 +422,67 @@ private:
             _reserveNode->addChild(reserveArea, -1);
         }
 
-        // Set up touch handling for reserve area
+        // Set up touch handling for the play field and the reserve area
+        setupFieldTouch();
         setupReserveTouch();
     }
 
+    /**
+     * One listener for the whole play field
+     * The touch is converted to main area space once and resolved to the
+     * topmost card through the hit index, instead of every card view
+     * registering and testing its own listener.
+     */
+    void setupFieldTouch()
+    {
+        _fieldTouchListener = EventListenerTouchOneByOne::create();
+        _fieldTouchListener->setSwallowTouches(true);
+
+        _fieldTouchListener->onTouchBegan = [this](Touch* touch, Event*) -> bool {
+            if (!_mainAreaNode->isVisible()) {
+                return false;
+            }
+            int cardId = _fieldHitIndex.hitTest(_mainAreaNode->convertToNodeSpace(touch->getLocation()));
+            CardView* cardDisplay = getCardView(cardId);
+            if (!cardDisplay) {
+                return false;
+            }
+            _pressedCardId = cardId;
+            cardDisplay->setHighlighted(true);
+            return true;
+            };
+
+        _fieldTouchListener->onTouchEnded = [this](Touch*, Event*) {
+            int cardId = releasePressedCard();
+            if (cardId != CardHitIndex::kNoCard && _cardTouchCallback) {
+                _cardTouchCallback(cardId);
+            }
+            };
+
+        _fieldTouchListener->onTouchCancelled = [this](Touch*, Event*) {
+            releasePressedCard();
+            };
+
+        _eventDispatcher->addEventListenerWithSceneGraphPriority(_fieldTouchListener, _mainAreaNode);
+    }
+
+    /**
+     * Clear the pressed card's highlight
+     * @return Its ID, or kNoCard if it left the field while pressed
+     */
+    int releasePressedCard()
+    {
+        int cardId = _pressedCardId;
+        _pressedCardId = CardHitIndex::kNoCard;
+
+        auto it = _cardViewMap.find(cardId);
+        if (it == _cardViewMap.end()) {
+            return CardHitIndex::kNoCard;
+        }
+        it->second.view->setHighlighted(false);
+        return it->second.area == CardArea::FIELD ? cardId : CardHitIndex::kNoCard;
+    }
+
     void setupReserveTouch()
     {
         // Remove existing touch listener
@@ -289,7 +526,12 @@ private:
         _eventDispatcher->addEventListenerWithSceneGraphPriority(_reserveTouchListener, _reserveNode);
     }
 
-    std::unordered_map<int, CardView*> _cardViewMap; // Map of card ID to card view
+    std::unordered_map<int, DisplayedCard> _cardViewMap; // Map of card ID to card view
+    unsigned int _displayGeneration; // Number of updateDisplay() calls
+    CardViewPool _cardViewPool; // Detached card views kept for reuse
+    CardHitIndex _fieldHitIndex; // Rects of the field cards in main area space
+    int _pressedCardId; // Field card under the current touch
+    int _hintCardId; // Card blinking as a hint
     std::function<void(int)> _cardTouchCallback; // Callback for card clicks
     std::function<void()> _reserveClickCallback; // Callback for reserve clicks
 
@@ -298,6 +540,7 @@ private:
     cocos2d::Node* _reserveNode;  // Reserve node
 
     cocos2d::Sprite* _reserveBackground; // Reserve background
+    cocos2d::EventListenerTouchOneByOne* _fieldTouchListener; // Play field touch listener
     cocos2d::EventListenerTouchOneByOne* _reserveTouchListener; // Reserve touch listener
 };
 
@@ -0,0 +1,112 @@
+#pragma once
+#ifndef HEADLESS_GAME_VIEW_H
+#define HEADLESS_GAME_VIEW_H
+
+#include "IGameView.h"
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+/**
+ * What a headless view was asked to show
+ */
+enum class ViewEventType : uint8_t
+{
+    DISPLAY,    // updateDisplay
+    CARD_MOVE,  // showCardMove
+    HINT,       // showHint
+    CLEAR_HINT  // clearHint
+};
+
+struct ViewEvent
+{
+    ViewEventType type;
+    int cardId; // Moved or hinted card, -1 otherwise
+};
+
+/**
+ * Game view without a scene
+ * Lets GameController play games with no GL context or Director, e.g. in
+ * balancing runs and soak tests. Nothing is drawn and moves finish at
+ * once. Player input is fed in with clickCard() / clickReserve(), through
+ * the same callbacks GameView calls on touches. With recording on, every
+ * call the controller makes is kept for tests to check; off, the view
+ * costs nothing per move.
+ */
+class HeadlessGameView : public IGameView
+{
+public:
+    HeadlessGameView() : _recording(false), _displayCount(0), _hintCardId(-1) {}
+
+    void updateDisplay(GameModel* /*model*/) override
+    {
+        _displayCount++;
+        record(ViewEventType::DISPLAY, -1);
+    }
+
+    void clearDisplay() override { _hintCardId = -1; }
+
+    void showCardMove(GameModel* model, int cardId) override
+    {
+        record(ViewEventType::CARD_MOVE, cardId);
+        updateDisplay(model);
+    }
+
+    void showHint(int cardId) override
+    {
+        _hintCardId = cardId;
+        record(ViewEventType::HINT, cardId);
+    }
+
+    void clearHint() override
+    {
+        _hintCardId = -1;
+        record(ViewEventType::CLEAR_HINT, -1);
+    }
+
+    void setCardClickCallback(const std::function<void(int)>& callback) override { _cardClickCallback = callback; }
+    void setReserveClickCallback(const std::function<void()>& callback) override { _reserveClickCallback = callback; }
+
+    // Play input as a touch on a field card or on the reserve stack would
+    void clickCard(int cardId)
+    {
+        if (_cardClickCallback) {
+            _cardClickCallback(cardId);
+        }
+    }
+
+    void clickReserve()
+    {
+        if (_reserveClickCallback) {
+            _reserveClickCallback();
+        }
+    }
+
+    // Keep the calls made from now on
+    void setRecording(bool recording) { _recording = recording; }
+    const std::vector<ViewEvent>& getEvents() const { return _events; }
+    void clearEvents() { _events.clear(); }
+
+    unsigned int getDisplayCount() const { return _displayCount; }
+    int getHintCardId() const { return _hintCardId; }
+
+private:
+    void record(ViewEventType type, int cardId)
+    {
+        if (_recording) {
+            ViewEvent event;
+            event.type = type;
+            event.cardId = cardId;
+            _events.push_back(event);
+        }
+    }
+
+    bool _recording;
+    std::vector<ViewEvent> _events;
+    unsigned int _displayCount;
+    int _hintCardId; // Card shown as a hint, -1 if none
+    std::function<void(int)> _cardClickCallback;
+    std::function<void()> _reserveClickCallback;
+};
+
+#endif // HEADLESS_GAME_VIEW_H
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef I_GAME_VIEW_H
+#define I_GAME_VIEW_H
+
+#include "cocos2d.h"
+#include <functional>
+
+// Forward declaration
+class GameModel;
+
+/**
+ * What GameController needs from a game view
+ * GameView draws the game with cocos2d nodes; HeadlessGameView runs
+ * without a scene, so the controller can play games with no GL context or
+ * Director. The model is always up to date when a view is called; views
+ * only show it.
+ */
+class IGameView
+{
+public:
+    virtual ~IGameView() = default;
+
+    /**
+     * Show the game as the model has it now
+     * @param model Game data model
+     */
+    virtual void updateDisplay(GameModel* model) = 0;
+
+    // Forget every card shown; a new game starts over with card IDs from 0
+    virtual void clearDisplay() = 0;
+
+    /**
+     * Show a card that a match or draw has just made the active card
+     * The next move may come before an animation of this one ends; views
+     * show the model as it is then rather than queueing the animations.
+     * @param model Game data model, already updated by the move
+     * @param cardId The new active card
+     */
+    virtual void showCardMove(GameModel* model, int cardId) = 0;
+
+    // Make a card blink as the suggested next move, and stop it
+    virtual void showHint(int cardId) = 0;
+    virtual void clearHint() = 0;
+
+    // Player input: a field card was clicked, or the reserve stack
+    virtual void setCardClickCallback(const std::function<void(int)>& callback) = 0;
+    virtual void setReserveClickCallback(const std::function<void()>& callback) = 0;
+
+    // Node to add to the scene, nullptr for views without one
+    virtual cocos2d::Node* getNode() { return nullptr; }
+};
+
+#endif // I_GAME_VIEW_H
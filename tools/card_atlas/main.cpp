@@ -0,0 +1,265 @@
+/**
+ * Card atlas builder
+ * Composes the 52 card faces and the card back from the loose images
+ * under <resources-dir>/res, the same way CardView layers them, and packs
+ * them into one texture plus a SpriteFrameCache plist (see CardAtlas.h).
+ *
+ * Usage:
+ *   CardAtlasBuilder <resources-dir> [--padding <px>] [--columns <n>]
+ */
+
+#include "../../Classes/utils/CardAtlas.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+// Straight-alpha RGBA8888 pixels, top row first
+struct RgbaImage
+{
+    RgbaImage() : width(0), height(0) {}
+
+    int width;
+    int height;
+    std::vector<unsigned char> pixels;
+};
+
+bool loadImage(const std::string& path, RgbaImage& image)
+{
+    Image source;
+    if (!source.initWithImageFile(path)) {
+        std::fprintf(stderr, "CardAtlasBuilder: cannot read %s\n", path.c_str());
+        return false;
+    }
+    image.width = source.getWidth();
+    image.height = source.getHeight();
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+
+    const unsigned char* data = source.getData();
+    if (source.getRenderFormat() == Texture2D::PixelFormat::RGBA8888) {
+        std::copy(data, data + image.pixels.size(), image.pixels.begin());
+    }
+    else if (source.getRenderFormat() == Texture2D::PixelFormat::RGB888) {
+        for (size_t i = 0; i < image.pixels.size() / 4; ++i) {
+            image.pixels[i * 4 + 0] = data[i * 3 + 0];
+            image.pixels[i * 4 + 1] = data[i * 3 + 1];
+            image.pixels[i * 4 + 2] = data[i * 3 + 2];
+            image.pixels[i * 4 + 3] = 255;
+        }
+    }
+    else {
+        std::fprintf(stderr, "CardAtlasBuilder: %s must be RGB or RGBA\n", path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Draw a layer centred at (centerX, centerY) in bottom-up card coordinates,
+ * as a child sprite with the default anchor would be
+ */
+void blendCentered(RgbaImage& target, const RgbaImage& layer, float centerX, float centerY)
+{
+    int left = static_cast<int>(centerX - layer.width / 2.0f);
+    int top = target.height - static_cast<int>(centerY + layer.height / 2.0f);
+    for (int y = 0; y < layer.height; ++y) {
+        int targetY = top + y;
+        if (targetY < 0 || targetY >= target.height) {
+            continue;
+        }
+        for (int x = 0; x < layer.width; ++x) {
+            int targetX = left + x;
+            if (targetX < 0 || targetX >= target.width) {
+                continue;
+            }
+            const unsigned char* src = &layer.pixels[(static_cast<size_t>(y) * layer.width + x) * 4];
+            unsigned char* dst = &target.pixels[(static_cast<size_t>(targetY) * target.width + targetX) * 4];
+            float srcAlpha = src[3] / 255.0f;
+            float dstAlpha = dst[3] / 255.0f;
+            float outAlpha = srcAlpha + dstAlpha * (1.0f - srcAlpha);
+            for (int c = 0; c < 3; ++c) {
+                float color = outAlpha > 0.0f
+                    ? (src[c] * srcAlpha + dst[c] * dstAlpha * (1.0f - srcAlpha)) / outAlpha
+                    : 0.0f;
+                dst[c] = static_cast<unsigned char>(std::min(255.0f, color + 0.5f));
+            }
+            dst[3] = static_cast<unsigned char>(outAlpha * 255.0f + 0.5f);
+        }
+    }
+}
+
+void copyInto(RgbaImage& atlas, const RgbaImage& card, int left, int top)
+{
+    for (int y = 0; y < card.height; ++y) {
+        std::copy(card.pixels.begin() + static_cast<size_t>(y) * card.width * 4,
+            card.pixels.begin() + static_cast<size_t>(y + 1) * card.width * 4,
+            atlas.pixels.begin() + (static_cast<size_t>(top + y) * atlas.width + left) * 4);
+    }
+}
+
+struct AtlasFrame
+{
+    std::string name;
+    int x;
+    int y;
+};
+
+std::string buildPlist(const std::vector<AtlasFrame>& frames, int cardWidth, int cardHeight,
+    int atlasWidth, int atlasHeight, const std::string& textureName)
+{
+    std::string plist =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!DOCTYPE plist PUBLIC \"-//Apple//DTD PLIST 1.0//EN\" \"http://www.apple.com/DTDs/PropertyList-1.0.dtd\">\n"
+        "<plist version=\"1.0\">\n"
+        "<dict>\n"
+        "    <key>frames</key>\n"
+        "    <dict>\n";
+    for (const auto& frame : frames) {
+        plist += StringUtils::format(
+            "        <key>%s</key>\n"
+            "        <dict>\n"
+            "            <key>frame</key>\n"
+            "            <string>{{%d,%d},{%d,%d}}</string>\n"
+            "            <key>offset</key>\n"
+            "            <string>{0,0}</string>\n"
+            "            <key>rotated</key>\n"
+            "            <false/>\n"
+            "            <key>sourceColorRect</key>\n"
+            "            <string>{{0,0},{%d,%d}}</string>\n"
+            "            <key>sourceSize</key>\n"
+            "            <string>{%d,%d}</string>\n"
+            "        </dict>\n",
+            frame.name.c_str(), frame.x, frame.y, cardWidth, cardHeight,
+            cardWidth, cardHeight, cardWidth, cardHeight);
+    }
+    plist += StringUtils::format(
+        "    </dict>\n"
+        "    <key>metadata</key>\n"
+        "    <dict>\n"
+        "        <key>format</key>\n"
+        "        <integer>2</integer>\n"
+        "        <key>realTextureFileName</key>\n"
+        "        <string>%s</string>\n"
+        "        <key>size</key>\n"
+        "        <string>{%d,%d}</string>\n"
+        "        <key>textureFileName</key>\n"
+        "        <string>%s</string>\n"
+        "    </dict>\n"
+        "</dict>\n"
+        "</plist>\n",
+        textureName.c_str(), atlasWidth, atlasHeight, textureName.c_str());
+    return plist;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string resourcesDir;
+    int padding = 2;
+    int columns = 8;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--padding" && i + 1 < argc) {
+            padding = std::max(0, std::atoi(argv[++i]));
+        }
+        else if (arg == "--columns" && i + 1 < argc) {
+            columns = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (resourcesDir.empty() && !arg.empty() && arg[0] != '-') {
+            resourcesDir = arg;
+        }
+        else {
+            resourcesDir.clear();
+            break;
+        }
+    }
+    if (resourcesDir.empty()) {
+        std::printf("Usage: CardAtlasBuilder <resources-dir> [--padding <px>] [--columns <n>]\n");
+        return 2;
+    }
+    resourcesDir += "/";
+
+    // Blend in straight alpha and write the atlas the way the sources are stored
+    Image::setPNGPremultipliedAlphaEnabled(false);
+
+    RgbaImage base;
+    if (!loadImage(resourcesDir + CardAtlas::getCardBaseFile(), base)) {
+        return 1;
+    }
+
+    // The back first, then the faces by suit and face
+    std::vector<RgbaImage> cards;
+    std::vector<std::string> names;
+    cards.push_back(base);
+    names.push_back(CardAtlas::getBackFrameName());
+    for (int suit = CST_CLUBS; suit < CST_NUM_CARD_SUIT_TYPES; ++suit) {
+        for (int face = CFT_ACE; face < CFT_NUM_CARD_FACE_TYPES; ++face) {
+            CardFaceType cardFace = static_cast<CardFaceType>(face);
+            CardSuitType cardSuit = static_cast<CardSuitType>(suit);
+            RgbaImage bigNumber;
+            RgbaImage smallNumber;
+            RgbaImage suitIcon;
+            if (!loadImage(resourcesDir + CardAtlas::getNumberFile(cardFace, cardSuit, true), bigNumber) ||
+                !loadImage(resourcesDir + CardAtlas::getNumberFile(cardFace, cardSuit, false), smallNumber) ||
+                !loadImage(resourcesDir + CardAtlas::getSuitFile(cardSuit), suitIcon)) {
+                return 1;
+            }
+
+            // Same placement as the child sprites CardView used to add
+            RgbaImage card = base;
+            const float inset = static_cast<float>(CardAtlas::kCornerInset);
+            blendCentered(card, bigNumber, base.width / 2.0f, base.height / 2.0f);
+            blendCentered(card, smallNumber, inset, base.height - inset);
+            blendCentered(card, suitIcon, base.width - inset, base.height - inset);
+            cards.push_back(card);
+            names.push_back(CardAtlas::getFaceFrameName(cardFace, cardSuit));
+        }
+    }
+
+    int cellWidth = base.width + padding;
+    int cellHeight = base.height + padding;
+    int rows = (static_cast<int>(cards.size()) + columns - 1) / columns;
+
+    RgbaImage atlas;
+    atlas.width = columns * cellWidth + padding;
+    atlas.height = rows * cellHeight + padding;
+    atlas.pixels.assign(static_cast<size_t>(atlas.width) * atlas.height * 4, 0);
+
+    std::vector<AtlasFrame> frames;
+    for (size_t i = 0; i < cards.size(); ++i) {
+        AtlasFrame frame;
+        frame.name = names[i];
+        frame.x = padding + static_cast<int>(i % columns) * cellWidth;
+        frame.y = padding + static_cast<int>(i / columns) * cellHeight;
+        copyInto(atlas, cards[i], frame.x, frame.y);
+        frames.push_back(frame);
+    }
+
+    std::string texturePath = resourcesDir + CardAtlas::getTextureFile();
+    std::string plistPath = resourcesDir + CardAtlas::getPlistFile();
+    std::string textureName = CardAtlas::getTextureFile().substr(CardAtlas::getTextureFile().find_last_of('/') + 1);
+
+    Image output;
+    if (!output.initWithRawData(&atlas.pixels[0], static_cast<ssize_t>(atlas.pixels.size()),
+            atlas.width, atlas.height, 8, false) ||
+        !output.saveToFile(texturePath, false)) {
+        std::fprintf(stderr, "CardAtlasBuilder: cannot write %s\n", texturePath.c_str());
+        return 1;
+    }
+    if (!FileUtils::getInstance()->writeStringToFile(
+            buildPlist(frames, base.width, base.height, atlas.width, atlas.height, textureName), plistPath)) {
+        std::fprintf(stderr, "CardAtlasBuilder: cannot write %s\n", plistPath.c_str());
+        return 1;
+    }
+
+    std::printf("CardAtlasBuilder: %d frames of %dx%d in a %dx%d atlas\n",
+        static_cast<int>(frames.size()), base.width, base.height, atlas.width, atlas.height);
+    return 0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#ifndef TOOLS_ALLOCATION_COUNTER_H
+#define TOOLS_ALLOCATION_COUNTER_H
+
+/**
+ * Heap accounting for the whole process
+ * Replaces the global operator new/delete with counting versions, for the
+ * benchmarks' allocations-per-operation figures. The replacements are
+ * definitions, so only a tool's main.cpp may include this header.
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<size_t> g_allocationCount(0);
+static std::atomic<size_t> g_allocatedBytes(0);
+
+void* operator new(size_t size)
+{
+    g_allocationCount++;
+    g_allocatedBytes += size;
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+    std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+    std::free(memory);
+}
+
+#endif // TOOLS_ALLOCATION_COUNTER_H
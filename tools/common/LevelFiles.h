@@ -0,0 +1,76 @@
+#pragma once
+#ifndef TOOLS_LEVEL_FILES_H
+#define TOOLS_LEVEL_FILES_H
+
+/**
+ * Level files for the command-line tools
+ * Levels are stored one per level_N.json file. A directory stands for the
+ * level files it holds, in level id order.
+ */
+
+#include "cocos2d.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct LevelFile
+{
+    LevelFile() : levelId(0) {}
+
+    int levelId;
+    std::string fullPath;
+};
+
+// Level id from a level_N.json file name or path, false for other files
+inline bool parseLevelFileName(const std::string& path, int& levelId)
+{
+    std::string name = path.substr(path.find_last_of("/\\") + 1);
+    char suffix[8] = { 0 };
+    return std::sscanf(name.c_str(), "level_%d.%7s", &levelId, suffix) == 2 && std::strcmp(suffix, "json") == 0;
+}
+
+// The level_N.json files of a directory, sorted by level id
+inline std::vector<LevelFile> listLevelFiles(const std::string& levelsDir)
+{
+    std::vector<LevelFile> levels;
+    for (const auto& path : cocos2d::FileUtils::getInstance()->listFiles(levelsDir)) {
+        LevelFile level;
+        if (parseLevelFileName(path, level.levelId)) {
+            level.fullPath = path;
+            levels.push_back(level);
+        }
+    }
+    std::sort(levels.begin(), levels.end(), [](const LevelFile& a, const LevelFile& b) {
+        return a.levelId < b.levelId;
+    });
+    return levels;
+}
+
+/**
+ * Level files named on a command line
+ * A directory adds its level files; any other path is taken as one level
+ * file, with level id 0 unless it is named level_N.json.
+ */
+inline std::vector<LevelFile> collectLevelFiles(const std::vector<std::string>& paths)
+{
+    std::vector<LevelFile> levels;
+    for (const auto& path : paths) {
+        if (cocos2d::FileUtils::getInstance()->isDirectoryExist(path)) {
+            std::vector<LevelFile> directoryLevels = listLevelFiles(path);
+            levels.insert(levels.end(), directoryLevels.begin(), directoryLevels.end());
+            continue;
+        }
+        LevelFile level;
+        if (!parseLevelFileName(path, level.levelId)) {
+            level.levelId = 0;
+        }
+        level.fullPath = path;
+        levels.push_back(level);
+    }
+    return levels;
+}
+
+#endif // TOOLS_LEVEL_FILES_H
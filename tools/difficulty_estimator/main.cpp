@@ -0,0 +1,254 @@
+/**
+ * Level difficulty estimator
+ * Plays every level many times with simulated players and reports the
+ * expected win rate per player policy, with its 95% confidence interval,
+ * the field cards left and the draws used. Playouts of a level run on all
+ * cores; the same seed gives the same report on any number of threads.
+ * Runs headless: only FileUtils is used from the engine.
+ *
+ * Usage:
+ *   DifficultyEstimator <level-file-or-dir>... [--playouts <n>] [--policy random|greedy|lookahead|all]
+ *                       [--depth <n>] [--seed <n>] [--threads <n>] [--json <file>]
+ */
+
+#include "../../Classes/configs/loaders/LevelConfigLoader.h"
+#include "../../Classes/services/DifficultyEstimator.h"
+#include "../../Classes/utils/WorkStealingScheduler.h"
+#include "../common/LevelFiles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+struct PolicyReport
+{
+    PlayoutPolicy policy;
+    DifficultyEstimate estimate;
+};
+
+struct LevelReport
+{
+    LevelReport() : levelId(0), loaded(false), fieldCards(0), reserveCards(0) {}
+
+    int levelId;
+    std::string fullPath;
+    bool loaded;
+    int fieldCards;
+    int reserveCards;
+    std::vector<PolicyReport> policies;
+};
+
+struct ToolOptions
+{
+    ToolOptions() : threads(0) {}
+
+    std::vector<std::string> paths;
+    std::vector<PlayoutPolicy> policies;
+    std::string jsonPath;
+    int threads;
+    EstimatorOptions estimator;
+};
+
+void printUsage()
+{
+    std::printf("Usage: DifficultyEstimator <level-file-or-dir>... [--playouts <n>]\n"
+                "                           [--policy random|greedy|lookahead|all] [--depth <n>]\n"
+                "                           [--seed <n>] [--threads <n>] [--json <file>]\n");
+}
+
+bool parsePolicy(const std::string& name, std::vector<PlayoutPolicy>& policies)
+{
+    if (name == "random") {
+        policies.push_back(PlayoutPolicy::RANDOM);
+    }
+    else if (name == "greedy") {
+        policies.push_back(PlayoutPolicy::GREEDY_UNCOVER);
+    }
+    else if (name == "lookahead") {
+        policies.push_back(PlayoutPolicy::LOOKAHEAD);
+    }
+    else if (name == "all") {
+        policies.push_back(PlayoutPolicy::RANDOM);
+        policies.push_back(PlayoutPolicy::GREEDY_UNCOVER);
+        policies.push_back(PlayoutPolicy::LOOKAHEAD);
+    }
+    else {
+        return false;
+    }
+    return true;
+}
+
+bool parseArguments(int argc, char** argv, ToolOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--playouts" && hasValue) {
+            options.estimator.playouts = std::atoi(argv[++i]);
+        }
+        else if (arg == "--policy" && hasValue) {
+            if (!parsePolicy(argv[++i], options.policies)) {
+                return false;
+            }
+        }
+        else if (arg == "--depth" && hasValue) {
+            options.estimator.lookaheadDepth = std::atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && hasValue) {
+            options.estimator.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            options.paths.push_back(arg);
+        }
+        else {
+            return false;
+        }
+    }
+    if (options.policies.empty()) {
+        parsePolicy("all", options.policies);
+    }
+    return !options.paths.empty() && options.estimator.playouts > 0 && options.estimator.lookaheadDepth > 0;
+}
+
+void writeJson(const std::string& path, const std::vector<LevelReport>& reports, const ToolOptions& options,
+    double totalMs, int threads)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("playouts");
+    writer.Int(options.estimator.playouts);
+    writer.Key("seed");
+    writer.Uint64(options.estimator.seed);
+    writer.Key("lookahead_depth");
+    writer.Int(options.estimator.lookaheadDepth);
+    writer.Key("threads");
+    writer.Int(threads);
+    writer.Key("total_ms");
+    writer.Double(totalMs);
+    writer.Key("levels");
+    writer.StartArray();
+    for (const auto& report : reports) {
+        writer.StartObject();
+        writer.Key("level_id");
+        writer.Int(report.levelId);
+        writer.Key("file");
+        writer.String(report.fullPath.c_str());
+        writer.Key("loaded");
+        writer.Bool(report.loaded);
+        writer.Key("field_cards");
+        writer.Int(report.fieldCards);
+        writer.Key("reserve_cards");
+        writer.Int(report.reserveCards);
+        writer.Key("policies");
+        writer.StartArray();
+        for (const auto& policy : report.policies) {
+            const DifficultyEstimate& estimate = policy.estimate;
+            writer.StartObject();
+            writer.Key("policy");
+            writer.String(DifficultyEstimator::getPolicyName(policy.policy));
+            writer.Key("wins");
+            writer.Int(estimate.wins);
+            writer.Key("win_rate");
+            writer.Double(estimate.winRate);
+            writer.Key("win_rate_low");
+            writer.Double(estimate.winRateLow);
+            writer.Key("win_rate_high");
+            writer.Double(estimate.winRateHigh);
+            writer.Key("avg_remaining_cards");
+            writer.Double(estimate.averageRemainingCards);
+            writer.Key("avg_draws");
+            writer.Double(estimate.averageDraws);
+            writer.Key("avg_moves");
+            writer.Double(estimate.averageMoves);
+            writer.Key("wall_ms");
+            writer.Double(estimate.elapsedMs);
+            writer.EndObject();
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    std::ofstream out(path.c_str());
+    out << buffer.GetString() << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ToolOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // FileUtils is created here, before any worker thread touches it
+    std::vector<LevelFile> levels = collectLevelFiles(options.paths);
+    std::vector<LevelReport> reports(levels.size());
+    WorkStealingScheduler scheduler(options.threads);
+
+    std::printf("%-8s %-10s %10s %19s %10s %8s %10s\n",
+        "level", "policy", "win rate", "95% interval", "remaining", "draws", "ms");
+    int failed = 0;
+    auto startTime = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < levels.size(); ++i) {
+        LevelReport& report = reports[i];
+        report.levelId = levels[i].levelId;
+        report.fullPath = levels[i].fullPath;
+
+        // Levels are estimated one after another, each on every worker
+        LevelConfig levelConfig;
+        DifficultyEstimator estimator;
+        report.loaded = LevelConfigLoader::loadLevelConfigFromFile(report.fullPath, levelConfig) &&
+                        estimator.prepare(levelConfig);
+        if (!report.loaded) {
+            std::fprintf(stderr, "DifficultyEstimator: cannot estimate %s\n", report.fullPath.c_str());
+            failed++;
+            continue;
+        }
+        report.fieldCards = static_cast<int>(levelConfig.getMainAreaCards().size());
+        report.reserveCards = static_cast<int>(levelConfig.getBackupAreaCards().size());
+
+        for (PlayoutPolicy policy : options.policies) {
+            EstimatorOptions estimatorOptions = options.estimator;
+            estimatorOptions.policy = policy;
+            PolicyReport policyReport;
+            policyReport.policy = policy;
+            policyReport.estimate = estimator.estimate(estimatorOptions, scheduler);
+            report.policies.push_back(policyReport);
+
+            const DifficultyEstimate& estimate = policyReport.estimate;
+            std::printf("%-8d %-10s %9.2f%% [%6.2f%%, %6.2f%%] %10.2f %8.2f %10.1f\n",
+                report.levelId, DifficultyEstimator::getPolicyName(policy), estimate.winRate * 100.0,
+                estimate.winRateLow * 100.0, estimate.winRateHigh * 100.0,
+                estimate.averageRemainingCards, estimate.averageDraws, estimate.elapsedMs);
+        }
+    }
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    if (!options.jsonPath.empty()) {
+        writeJson(options.jsonPath, reports, options, totalMs, scheduler.getWorkerCount());
+    }
+
+    std::printf("DifficultyEstimator: %d levels, %d playouts x %d policies each, %.1f ms on %d threads\n",
+        static_cast<int>(reports.size()), options.estimator.playouts, static_cast<int>(options.policies.size()),
+        totalMs, scheduler.getWorkerCount());
+
+    return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,465 @@
+/**
+ * Game logic microbenchmarks
+ * Times the per-level and per-move paths of the game on generated levels:
+ * level JSON parsing, building a game model, match/draw/undo cycles through
+ * GameModel and move generation over compact states. Generated levels lay
+ * their cards out side by side, so the move benchmarks run again on
+ * stacked pyramid boards, where every move goes through the occlusion
+ * checks. Each benchmark
+ * reports percentiles and heap allocations per operation; the JSON report
+ * keeps its keys and benchmark order fixed, so reports diff cleanly and a
+ * baseline report can gate a build. Runs headless, like the level tools.
+ *
+ * Usage:
+ *   GameBench [--levels <n>] [--iterations <n>] [--json <file>]
+ *             [--baseline <file>] [--max-regression <percent>]
+ */
+
+#include "../../Classes/configs/loaders/LevelConfigLoader.h"
+#include "../../Classes/configs/loaders/LevelConfigParser.h"
+#include "../../Classes/services/GameModelFromLevelGenerator.h"
+#include "../../Classes/services/LevelGenerator.h"
+#include "../../Classes/services/MoveGenerator.h"
+#include "../../Classes/models/CompactGameState.h"
+#include "../../Classes/utils/GameRandom.h"
+#include "../common/AllocationCounter.h"
+#include "json/document.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+const uint64_t kFirstLevelSeed = 1;    // Levels are generated, so every run times the same ones
+const uint32_t kSessionSeed = 7;       // Seed of the random sessions played on them
+const int kMaxSessionMoves = 300;
+const int kMinPyramidRows = 5;         // 15 to 28 field cards
+const int kMaxPyramidRows = 7;
+const int kPyramidReserveCards = 12;
+
+struct BenchOptions
+{
+    BenchOptions() : levelCount(32), iterations(2000), maxRegressionPercent(10.0) {}
+
+    int levelCount;
+    int iterations;
+    std::string jsonPath;
+    std::string baselinePath;
+    double maxRegressionPercent;
+};
+
+// One generated level with everything the benchmarks replay on it
+struct BenchLevel
+{
+    BenchLevel() : gameModel(nullptr) {}
+
+    std::string json;
+    LevelConfig levelConfig;
+    GameModel* gameModel;              // Reset to the deal after every cycle
+    std::vector<MoveRecord> moves;     // A legal session from the deal
+    CompactCardTable table;
+    std::vector<CompactGameState> states; // Every state of the session
+};
+
+struct BenchResult
+{
+    BenchResult() : samples(0), opsPerSample(0), p50(0), p90(0), p99(0), max(0), mean(0), allocsPerOp(0) {}
+
+    std::string name;
+    int samples;
+    int opsPerSample;
+    double p50;       // Nanoseconds per operation
+    double p90;
+    double p99;
+    double max;
+    double mean;
+    double allocsPerOp;
+};
+
+void printUsage()
+{
+    std::printf("Usage: GameBench [--levels <n>] [--iterations <n>] [--json <file>]\n"
+                "                 [--baseline <file>] [--max-regression <percent>]\n");
+}
+
+bool parseArguments(int argc, char** argv, BenchOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--levels" && hasValue) {
+            options.levelCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--iterations" && hasValue) {
+            options.iterations = std::atoi(argv[++i]);
+        }
+        else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        }
+        else if (arg == "--baseline" && hasValue) {
+            options.baselinePath = argv[++i];
+        }
+        else if (arg == "--max-regression" && hasValue) {
+            options.maxRegressionPercent = std::atof(argv[++i]);
+        }
+        else {
+            return false;
+        }
+    }
+    return options.levelCount > 0 && options.iterations > 0;
+}
+
+// A random legal session: mostly matches, draws when nothing matches
+void playSession(BenchLevel& level, std::mt19937& random)
+{
+    GameModel* gameModel = level.gameModel;
+    CompactGameState state;
+    CompactGameState::fromGameModel(*gameModel, level.table, state);
+    level.states.push_back(state);
+
+    MoveGenerator moveGenerator;
+    moveGenerator.setup(level.table);
+    for (int i = 0; i < kMaxSessionMoves && !gameModel->getFieldCards().empty(); ++i) {
+        LegalMoves legalMoves = moveGenerator.generate(state);
+        if (legalMoves.isEmpty()) {
+            break;
+        }
+
+        MoveRecord move = MoveRecord::draw();
+        if (legalMoves.matches && (random() % 4 != 0 || !legalMoves.canDraw)) {
+            std::vector<int> slots;
+            for (uint64_t bits = legalMoves.matches; bits; bits &= bits - 1) {
+                slots.push_back(GameUtils::lowestBitIndex(bits));
+            }
+            int slot = slots[random() % slots.size()];
+            move = MoveRecord::match(level.table.getCardId(slot));
+            state.applyMatch(static_cast<uint8_t>(slot));
+        }
+        else {
+            state.applyDraw();
+        }
+        gameModel->applyMove(move);
+        level.moves.push_back(move);
+        level.states.push_back(state);
+    }
+
+    // Back to the deal, the cycle benchmark starts from there
+    for (auto it = level.moves.rbegin(); it != level.moves.rend(); ++it) {
+        gameModel->revertMove(*it);
+    }
+}
+
+// Build the model, the level text and a session for levels whose config is set
+bool finishLevels(std::vector<BenchLevel>& levels)
+{
+    std::mt19937 random(kSessionSeed);
+    GameModelFromLevelGenerator levelGenerator;
+    for (BenchLevel& level : levels) {
+        level.json = LevelConfigLoader::saveLevelConfigToString(level.levelConfig);
+        level.gameModel = levelGenerator.createGameModelFromLevel(level.levelConfig);
+        if (!level.gameModel) {
+            return false;
+        }
+        playSession(level, random);
+    }
+    return !levels.empty();
+}
+
+// Levels hold non-copyable state, so the vector comes sized from the caller
+bool prepareLevels(std::vector<BenchLevel>& levels)
+{
+    std::vector<GeneratedLevel> generated = LevelGenerator::generateBatch(LevelGeneratorOptions(), kFirstLevelSeed,
+        static_cast<int>(levels.size()), 1);
+    if (generated.size() != levels.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < generated.size(); ++i) {
+        generated[i].applyTo(levels[i].levelConfig);
+    }
+    return finishLevels(levels);
+}
+
+/**
+ * Deal pyramid boards: each row is drawn over the one above it and every
+ * card covers half of two cards there, as on a classic tri-peaks board
+ */
+bool preparePyramids(std::vector<BenchLevel>& levels)
+{
+    GameRandom random(kFirstLevelSeed);
+    for (BenchLevel& level : levels) {
+        int rows = random.nextInt(kMinPyramidRows, kMaxPyramidRows);
+        std::vector<LevelConfig::CardItem> playfield;
+        for (int row = 0; row < rows; ++row) {
+            for (int column = 0; column <= row; ++column) {
+                LevelConfig::CardItem card;
+                card.cardValue = static_cast<CardFaceType>(random.nextInt(CFT_ACE, CFT_KING));
+                card.cardSuit = static_cast<CardSuitType>(random.nextInt(CST_CLUBS, CST_NUM_CARD_SUIT_TYPES - 1));
+                card.cardPosition = cocos2d::Vec2(540.0f + (column - row * 0.5f) * 190.0f, 1300.0f - row * 150.0f);
+                playfield.push_back(card);
+            }
+        }
+        std::vector<LevelConfig::CardItem> stack(kPyramidReserveCards);
+        for (auto& card : stack) {
+            card.cardValue = static_cast<CardFaceType>(random.nextInt(CFT_ACE, CFT_KING));
+            card.cardSuit = static_cast<CardSuitType>(random.nextInt(CST_CLUBS, CST_NUM_CARD_SUIT_TYPES - 1));
+            card.cardPosition = cocos2d::Vec2::ZERO;
+        }
+        level.levelConfig.setMainAreaCards(std::move(playfield));
+        level.levelConfig.setBackupAreaCards(std::move(stack));
+    }
+    return finishLevels(levels);
+}
+
+// Percentile by nearest rank over sorted samples
+double percentile(const std::vector<double>& sorted, double fraction)
+{
+    size_t rank = static_cast<size_t>(std::ceil(fraction * sorted.size()));
+    return sorted[rank > 0 ? rank - 1 : 0];
+}
+
+double roundTenth(double value)
+{
+    return std::round(value * 10.0) / 10.0;
+}
+
+/**
+ * Time a benchmark
+ * @param sample Runs one sample on a level and returns how many operations it made
+ */
+BenchResult runBench(const char* name, int iterations, std::vector<BenchLevel>& levels,
+    const std::function<int(BenchLevel&)>& sample)
+{
+    // Warm caches, arenas and reserved vectors before measuring
+    for (size_t i = 0; i < levels.size(); ++i) {
+        sample(levels[i]);
+    }
+
+    std::vector<double> nsPerOp;
+    nsPerOp.reserve(iterations);
+    size_t allocationsBefore = g_allocationCount;
+    long long totalOps = 0;
+    for (int i = 0; i < iterations; ++i) {
+        BenchLevel& level = levels[i % levels.size()];
+        auto start = std::chrono::steady_clock::now();
+        int ops = sample(level);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        ops = ops > 0 ? ops : 1;
+        nsPerOp.push_back(ns / ops);
+        totalOps += ops;
+    }
+    size_t allocations = g_allocationCount - allocationsBefore;
+
+    BenchResult result;
+    result.name = name;
+    result.samples = iterations;
+    result.opsPerSample = static_cast<int>(totalOps / iterations);
+    std::sort(nsPerOp.begin(), nsPerOp.end());
+    result.p50 = roundTenth(percentile(nsPerOp, 0.50));
+    result.p90 = roundTenth(percentile(nsPerOp, 0.90));
+    result.p99 = roundTenth(percentile(nsPerOp, 0.99));
+    result.max = roundTenth(nsPerOp.back());
+    double sum = 0.0;
+    for (double ns : nsPerOp) {
+        sum += ns;
+    }
+    result.mean = roundTenth(sum / nsPerOp.size());
+    result.allocsPerOp = roundTenth(static_cast<double>(allocations) / totalOps);
+    return result;
+}
+
+std::vector<BenchResult> runBenches(const BenchOptions& options, std::vector<BenchLevel>& levels,
+    std::vector<BenchLevel>& pyramids)
+{
+    std::vector<BenchResult> results;
+    volatile int sink = 0; // Keeps results alive so the work is not optimized away
+
+    // LevelConfigLoader's parsing path, without the file read
+    std::string buffer;
+    std::vector<LevelConfig::CardItem> playfield;
+    std::vector<LevelConfig::CardItem> stack;
+    results.push_back(runBench("level_parse", options.iterations, levels, [&](BenchLevel& level) {
+        buffer.assign(level.json); // In-place parsing needs a fresh copy of the text
+        LevelConfigParser::parseInsitu(&buffer[0], playfield, stack);
+        sink = sink + static_cast<int>(playfield.size());
+        return 1;
+    }));
+
+    GameModelFromLevelGenerator levelGenerator;
+    results.push_back(runBench("model_build", options.iterations, levels, [&](BenchLevel& level) {
+        GameModel* gameModel = levelGenerator.createGameModelFromLevel(level.levelConfig);
+        sink = sink + static_cast<int>(gameModel->getFieldCards().size());
+        delete gameModel;
+        return 1;
+    }));
+
+    // Play the session, then undo all of it; one operation is a move and its undo
+    auto moveCycle = [&](BenchLevel& level) {
+        for (MoveRecord& move : level.moves) {
+            level.gameModel->applyMove(move);
+        }
+        for (auto it = level.moves.rbegin(); it != level.moves.rend(); ++it) {
+            level.gameModel->revertMove(*it);
+        }
+        return static_cast<int>(level.moves.size());
+    };
+
+    MoveGenerator moveGenerator;
+    auto moveGeneration = [&](BenchLevel& level) {
+        moveGenerator.setup(level.table);
+        int count = 0;
+        for (const CompactGameState& state : level.states) {
+            count += moveGenerator.generate(state).getCount();
+        }
+        sink = sink + count;
+        return static_cast<int>(level.states.size());
+    };
+
+    results.push_back(runBench("move_cycle", options.iterations, levels, moveCycle));
+    results.push_back(runBench("move_generation", options.iterations, levels, moveGeneration));
+    results.push_back(runBench("move_cycle_stacked", options.iterations, pyramids, moveCycle));
+    results.push_back(runBench("move_generation_stacked", options.iterations, pyramids, moveGeneration));
+
+    return results;
+}
+
+std::string formatJson(const BenchOptions& options, int levelCount, const std::vector<BenchResult>& results)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("version");
+    writer.Int(1);
+    writer.Key("levels");
+    writer.Int(levelCount);
+    writer.Key("iterations");
+    writer.Int(options.iterations);
+    writer.Key("unit");
+    writer.String("ns_per_op");
+    writer.Key("benchmarks");
+    writer.StartArray();
+    for (const auto& result : results) {
+        writer.StartObject();
+        writer.Key("name");
+        writer.String(result.name.c_str());
+        writer.Key("samples");
+        writer.Int(result.samples);
+        writer.Key("ops_per_sample");
+        writer.Int(result.opsPerSample);
+        writer.Key("p50");
+        writer.Double(result.p50);
+        writer.Key("p90");
+        writer.Double(result.p90);
+        writer.Key("p99");
+        writer.Double(result.p99);
+        writer.Key("max");
+        writer.Double(result.max);
+        writer.Key("mean");
+        writer.Double(result.mean);
+        writer.Key("allocs_per_op");
+        writer.Double(result.allocsPerOp);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+    return std::string(buffer.GetString()) + "\n";
+}
+
+/**
+ * Compare medians with a previous report
+ * @return Number of benchmarks slower than the baseline by more than the allowed percent, -1 if unreadable
+ */
+int compareWithBaseline(const std::string& path, double maxRegressionPercent, const std::vector<BenchResult>& results)
+{
+    std::string content = FileUtils::getInstance()->getStringFromFile(path);
+    rapidjson::Document doc;
+    doc.Parse(content.c_str());
+    if (doc.HasParseError() || !doc.IsObject() || !doc.HasMember("benchmarks") || !doc["benchmarks"].IsArray()) {
+        return -1;
+    }
+
+    int regressions = 0;
+    const rapidjson::Value& baselines = doc["benchmarks"];
+    for (const auto& result : results) {
+        for (rapidjson::SizeType i = 0; i < baselines.Size(); ++i) {
+            const rapidjson::Value& baseline = baselines[i];
+            if (!baseline.HasMember("name") || !baseline["name"].IsString() || result.name != baseline["name"].GetString() ||
+                !baseline.HasMember("p50") || !baseline["p50"].IsNumber()) {
+                continue;
+            }
+            double baselineP50 = baseline["p50"].GetDouble();
+            double changePercent = baselineP50 > 0.0 ? (result.p50 / baselineP50 - 1.0) * 100.0 : 0.0;
+            bool regressed = changePercent > maxRegressionPercent;
+            std::printf("%-24s p50 %10.1f ns, baseline %10.1f ns, %+6.1f%%%s\n", result.name.c_str(),
+                result.p50, baselineP50, changePercent, regressed ? "  REGRESSION" : "");
+            if (regressed) {
+                regressions++;
+            }
+        }
+    }
+    return regressions;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    BenchOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    std::vector<BenchLevel> levels(options.levelCount);
+    std::vector<BenchLevel> pyramids(options.levelCount);
+    if (!prepareLevels(levels) || !preparePyramids(pyramids)) {
+        std::fprintf(stderr, "GameBench: cannot set up the levels\n");
+        return 1;
+    }
+
+    std::vector<BenchResult> results = runBenches(options, levels, pyramids);
+    for (auto& level : levels) {
+        delete level.gameModel;
+    }
+    for (auto& level : pyramids) {
+        delete level.gameModel;
+    }
+
+    std::printf("%-24s %8s %12s %12s %12s %12s %10s\n", "benchmark", "ops", "p50 ns", "p90 ns", "p99 ns", "max ns", "allocs");
+    for (const auto& result : results) {
+        std::printf("%-24s %8d %12.1f %12.1f %12.1f %12.1f %10.1f\n", result.name.c_str(), result.opsPerSample,
+            result.p50, result.p90, result.p99, result.max, result.allocsPerOp);
+    }
+
+    if (!options.jsonPath.empty()) {
+        std::ofstream out(options.jsonPath.c_str());
+        out << formatJson(options, static_cast<int>(levels.size()), results);
+        if (!out) {
+            std::fprintf(stderr, "GameBench: cannot write %s\n", options.jsonPath.c_str());
+            return 1;
+        }
+    }
+
+    if (!options.baselinePath.empty()) {
+        int regressions = compareWithBaseline(options.baselinePath, options.maxRegressionPercent, results);
+        if (regressions < 0) {
+            std::fprintf(stderr, "GameBench: not a benchmark report: %s\n", options.baselinePath.c_str());
+            return 1;
+        }
+        if (regressions > 0) {
+            std::printf("GameBench: %d benchmark(s) regressed by more than %.1f%%\n", regressions,
+                options.maxRegressionPercent);
+            return 1;
+        }
+    }
+    return 0;
+}
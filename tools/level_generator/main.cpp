@@ -0,0 +1,167 @@
+/**
+ * Procedural level generator
+ * Generates solvable levels for a range of seeds on all cores and writes
+ * them as level_N.json files plus an optional CSV report of their
+ * difficulty. Runs headless like LevelValidator.
+ *
+ * Usage:
+ *   LevelGenerator <output-dir> [--count <n>] [--seed <s>] [--first-id <n>] [--threads <n>]
+ *                  [--field <min> <max>] [--reserve <min> <max>]
+ *                  [--difficulty <min> <max>] [--attempts <n>] [--csv <file>]
+ */
+
+#include "../../Classes/configs/loaders/LevelConfigLoader.h"
+#include "../../Classes/services/LevelGenerator.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+struct GeneratorToolOptions
+{
+    GeneratorToolOptions() : count(100), seed(1), firstId(1), threads(0) {}
+
+    std::string outputDir;
+    std::string csvPath;
+    int count;
+    uint64_t seed;
+    int firstId;
+    int threads;
+    LevelGeneratorOptions generator;
+};
+
+void printUsage()
+{
+    std::printf("Usage: LevelGenerator <output-dir> [--count <n>] [--seed <s>] [--first-id <n>] [--threads <n>]\n"
+                "                      [--field <min> <max>] [--reserve <min> <max>]\n"
+                "                      [--difficulty <min> <max>] [--attempts <n>] [--csv <file>]\n");
+}
+
+bool parseArguments(int argc, char** argv, GeneratorToolOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool hasRange = i + 2 < argc;
+        if (arg == "--count" && hasValue) {
+            options.count = std::atoi(argv[++i]);
+        }
+        else if (arg == "--seed" && hasValue) {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--first-id" && hasValue) {
+            options.firstId = std::atoi(argv[++i]);
+        }
+        else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--field" && hasRange) {
+            options.generator.minFieldCards = std::atoi(argv[++i]);
+            options.generator.maxFieldCards = std::atoi(argv[++i]);
+        }
+        else if (arg == "--reserve" && hasRange) {
+            options.generator.minReserveCards = std::atoi(argv[++i]);
+            options.generator.maxReserveCards = std::atoi(argv[++i]);
+        }
+        else if (arg == "--difficulty" && hasRange) {
+            options.generator.minDifficulty = std::atof(argv[++i]);
+            options.generator.maxDifficulty = std::atof(argv[++i]);
+        }
+        else if (arg == "--attempts" && hasValue) {
+            options.generator.maxAttempts = std::atoi(argv[++i]);
+        }
+        else if (arg == "--csv" && hasValue) {
+            options.csvPath = argv[++i];
+        }
+        else if (!arg.empty() && arg[0] != '-' && options.outputDir.empty()) {
+            options.outputDir = arg;
+        }
+        else {
+            return false;
+        }
+    }
+    return !options.outputDir.empty() && options.count > 0;
+}
+
+void writeCsv(const std::string& path, const std::vector<GeneratedLevel>& levels, int firstId)
+{
+    std::ofstream out(path.c_str());
+    out << "level_id,seed,valid,attempts,field_cards,reserve_cards,score,min_moves,minimal,"
+           "required_draws,branching_factor,dead_end_ratio,nodes_expanded\n";
+    for (size_t i = 0; i < levels.size(); ++i) {
+        const GeneratedLevel& level = levels[i];
+        const LevelDifficulty& difficulty = level.difficulty;
+        out << firstId + static_cast<int>(i) << ','
+            << level.seed << ','
+            << (level.valid ? 1 : 0) << ','
+            << level.attempts << ','
+            << level.playfield.size() << ','
+            << level.stack.size() << ','
+            << difficulty.score << ','
+            << difficulty.minMoves << ','
+            << (difficulty.minimal ? 1 : 0) << ','
+            << difficulty.requiredDraws << ','
+            << difficulty.branchingFactor << ','
+            << difficulty.deadEndRatio << ','
+            << level.solverStats.nodesExpanded << '\n';
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    GeneratorToolOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // FileUtils is created here, before any worker thread could touch it
+    FileUtils* fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isDirectoryExist(options.outputDir) && !fileUtils->createDirectory(options.outputDir)) {
+        std::fprintf(stderr, "LevelGenerator: cannot create directory: %s\n", options.outputDir.c_str());
+        return 1;
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    std::vector<GeneratedLevel> levels = LevelGenerator::generateBatch(options.generator, options.seed,
+        options.count, options.threads);
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    int written = 0;
+    int candidates = 0;
+    for (size_t i = 0; i < levels.size(); ++i) {
+        candidates += levels[i].attempts;
+        if (!levels[i].valid) {
+            continue;
+        }
+        LevelConfig levelConfig;
+        levels[i].applyTo(levelConfig);
+        std::string path = StringUtils::format("%s/level_%d.json", options.outputDir.c_str(),
+            options.firstId + static_cast<int>(i));
+        if (fileUtils->writeStringToFile(LevelConfigLoader::saveLevelConfigToString(levelConfig), path)) {
+            written++;
+        }
+        else {
+            std::fprintf(stderr, "LevelGenerator: cannot write %s\n", path.c_str());
+        }
+    }
+
+    if (!options.csvPath.empty()) {
+        writeCsv(options.csvPath, levels, options.firstId);
+    }
+
+    std::printf("LevelGenerator: %d of %d levels written, %d candidates\n", written, options.count, candidates);
+    std::printf("LevelGenerator: %.1f ms (%.1f candidates/s)\n",
+        totalMs, totalMs > 0.0 ? candidates * 1000.0 / totalMs : 0.0);
+
+    return written == options.count ? 0 : 1;
+}
@@ -0,0 +1,92 @@
+/**
+ * Level pack converter
+ * Converts every level_N.json in a directory into one binary level pack
+ * (see LevelPack.h), then reopens the pack and checks each level against
+ * its JSON source.
+ *
+ * Usage:
+ *   LevelPacker <levels-dir> <output.pack>
+ */
+
+#include "../../Classes/configs/loaders/LevelConfigLoader.h"
+#include "../../Classes/configs/loaders/LevelPack.h"
+#include "../common/LevelFiles.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+bool sameCards(const LevelConfig::CardItemSpan& packed, const std::vector<LevelConfig::CardItem>& source)
+{
+    if (packed.size != source.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < source.size(); ++i) {
+        if (packed[i].cardValue != source[i].cardValue || packed[i].cardSuit != source[i].cardSuit ||
+            packed[i].cardPosition != source[i].cardPosition) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::printf("Usage: LevelPacker <levels-dir> <output.pack>\n");
+        return 2;
+    }
+    std::string levelsDir = argv[1];
+    std::string outputPath = argv[2];
+
+    FileUtils* fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isDirectoryExist(levelsDir)) {
+        std::fprintf(stderr, "LevelPacker: not a directory: %s\n", levelsDir.c_str());
+        return 1;
+    }
+
+    std::vector<LevelFile> levels = listLevelFiles(levelsDir);
+
+    LevelPackWriter writer;
+    for (const auto& level : levels) {
+        LevelConfig levelConfig;
+        if (!LevelConfigLoader::loadLevelConfigFromFile(level.fullPath, levelConfig) ||
+            !writer.addLevel(level.levelId, levelConfig)) {
+            std::fprintf(stderr, "LevelPacker: cannot convert %s\n", level.fullPath.c_str());
+            return 1;
+        }
+    }
+    if (!writer.saveToFile(outputPath)) {
+        std::fprintf(stderr, "LevelPacker: cannot write %s\n", outputPath.c_str());
+        return 1;
+    }
+
+    // Read the pack back the way the game does and compare with the sources
+    LevelPack pack;
+    if (!pack.open(outputPath) || pack.getLevelCount() != writer.getLevelCount()) {
+        std::fprintf(stderr, "LevelPacker: written pack does not validate: %s\n", outputPath.c_str());
+        return 1;
+    }
+    for (const auto& level : levels) {
+        LevelConfig levelConfig;
+        LevelConfig::CardItemSpan playfield;
+        LevelConfig::CardItemSpan stack;
+        LevelConfigLoader::loadLevelConfigFromFile(level.fullPath, levelConfig);
+        if (!pack.getLevelCards(level.levelId, playfield, stack) ||
+            !sameCards(playfield, levelConfig.getMainAreaCards()) ||
+            !sameCards(stack, levelConfig.getBackupAreaCards())) {
+            std::fprintf(stderr, "LevelPacker: level %d differs from %s\n", level.levelId, level.fullPath.c_str());
+            return 1;
+        }
+    }
+
+    std::printf("LevelPacker: %d levels, %ld bytes written to %s\n",
+        pack.getLevelCount(), fileUtils->getFileSize(outputPath), outputPath.c_str());
+    return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * Level JSON parsing microbenchmark
+ * Compares the previous RapidJSON DOM loading path with the streaming
+ * LevelConfigParser on synthetic levels of growing size, reporting time
+ * and heap allocations per parse.
+ *
+ * Usage:
+ *   LevelParseBench [--iterations <n>]
+ */
+
+#include "../../Classes/configs/loaders/LevelConfigLoader.h"
+#include "../../Classes/configs/loaders/LevelConfigParser.h"
+#include "../common/AllocationCounter.h"
+#include "json/document.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+// RapidJSON allocates through malloc, so the DOM gets a counting allocator
+struct CountingAllocator
+{
+    static const bool kNeedFree = true;
+
+    void* Malloc(size_t size)
+    {
+        if (!size) {
+            return nullptr;
+        }
+        g_allocationCount++;
+        g_allocatedBytes += size;
+        return std::malloc(size);
+    }
+
+    void* Realloc(void* memory, size_t originalSize, size_t newSize)
+    {
+        if (newSize == 0) {
+            std::free(memory);
+            return nullptr;
+        }
+        g_allocationCount++;
+        g_allocatedBytes += newSize > originalSize ? newSize - originalSize : 0;
+        return std::realloc(memory, newSize);
+    }
+
+    static void Free(void* memory) { std::free(memory); }
+};
+
+typedef rapidjson::GenericDocument<rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<CountingAllocator>, CountingAllocator>
+    CountedDocument;
+
+struct BenchResult
+{
+    double medianNs;
+    double allocationsPerParse;
+    double bytesPerParse;
+};
+
+// The DOM path LevelConfigLoader used before the streaming parser
+bool parseWithDocument(const std::string& content, LevelConfig& levelConfig)
+{
+    CountedDocument doc;
+    doc.Parse(content.c_str());
+    if (doc.HasParseError()) {
+        return false;
+    }
+    const char* areas[] = { "Playfield", "Stack" };
+    for (int area = 0; area < 2; ++area) {
+        if (!doc.HasMember(areas[area]) || !doc[areas[area]].IsArray()) {
+            continue;
+        }
+        std::vector<LevelConfig::CardItem> cards;
+        const CountedDocument::ValueType& cardArray = doc[areas[area]];
+        for (rapidjson::SizeType i = 0; i < cardArray.Size(); i++) {
+            const CountedDocument::ValueType& cardObj = cardArray[i];
+            LevelConfig::CardItem cardConfig;
+            if (cardObj.HasMember("CardFace") && cardObj["CardFace"].IsInt()) {
+                cardConfig.cardValue = static_cast<CardFaceType>(cardObj["CardFace"].GetInt());
+            }
+            if (cardObj.HasMember("CardSuit") && cardObj["CardSuit"].IsInt()) {
+                cardConfig.cardSuit = static_cast<CardSuitType>(cardObj["CardSuit"].GetInt());
+            }
+            if (cardObj.HasMember("Position") && cardObj["Position"].IsObject()) {
+                const CountedDocument::ValueType& posObj = cardObj["Position"];
+                if (posObj.HasMember("x") && posObj["x"].IsNumber() &&
+                    posObj.HasMember("y") && posObj["y"].IsNumber()) {
+                    cardConfig.cardPosition.x = posObj["x"].GetFloat();
+                    cardConfig.cardPosition.y = posObj["y"].GetFloat();
+                }
+            }
+            cards.push_back(cardConfig);
+        }
+        if (area == 0) {
+            levelConfig.setMainAreaCards(cards);
+        }
+        else {
+            levelConfig.setBackupAreaCards(cards);
+        }
+    }
+    return true;
+}
+
+std::string makeLevelJson(int cardCount)
+{
+    std::vector<LevelConfig::CardItem> playfield;
+    std::vector<LevelConfig::CardItem> stack;
+    for (int i = 0; i < cardCount; ++i) {
+        LevelConfig::CardItem card;
+        card.cardValue = static_cast<CardFaceType>(i % CFT_NUM_CARD_FACE_TYPES);
+        card.cardSuit = static_cast<CardSuitType>(i % CST_NUM_CARD_SUIT_TYPES);
+        card.cardPosition = Vec2(100.0f + (i * 37) % 900, 300.0f + (i * 53) % 1100);
+        (i % 4 == 3 ? stack : playfield).push_back(card);
+    }
+    LevelConfig levelConfig;
+    levelConfig.setMainAreaCards(playfield);
+    levelConfig.setBackupAreaCards(stack);
+    return LevelConfigLoader::saveLevelConfigToString(levelConfig);
+}
+
+template <typename ParseFunction>
+BenchResult runBench(int iterations, ParseFunction parse)
+{
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    size_t allocationsBefore = g_allocationCount;
+    size_t bytesBefore = g_allocatedBytes;
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        parse();
+        samples.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count());
+    }
+    // The samples vector was reserved up front, so only parse allocations are counted
+    BenchResult result;
+    std::sort(samples.begin(), samples.end());
+    result.medianNs = samples[samples.size() / 2];
+    result.allocationsPerParse = static_cast<double>(g_allocationCount - allocationsBefore) / iterations;
+    result.bytesPerParse = static_cast<double>(g_allocatedBytes - bytesBefore) / iterations;
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    int iterations = 2000;
+    if (argc == 3 && std::string(argv[1]) == "--iterations") {
+        iterations = std::max(1, std::atoi(argv[2]));
+    }
+    else if (argc != 1) {
+        std::printf("Usage: LevelParseBench [--iterations <n>]\n");
+        return 2;
+    }
+
+    std::printf("%6s %8s | %12s %10s %10s | %12s %10s %10s\n",
+        "cards", "bytes", "dom ns", "allocs", "alloc B", "sax ns", "allocs", "alloc B");
+
+    const int cardCounts[] = { 10, 50, 200, 800 };
+    for (int cardCount : cardCounts) {
+        std::string json = makeLevelJson(cardCount);
+
+        // Storage reused across parses, as a batch loader would
+        std::string buffer;
+        buffer.reserve(json.size());
+        std::vector<LevelConfig::CardItem> playfield;
+        std::vector<LevelConfig::CardItem> stack;
+
+        LevelConfig domConfig;
+        if (!parseWithDocument(json, domConfig)) {
+            std::fprintf(stderr, "LevelParseBench: DOM parse failed\n");
+            return 1;
+        }
+        buffer.assign(json);
+        LevelParseError error;
+        if (!LevelConfigParser::parseInsitu(&buffer[0], playfield, stack, &error) ||
+            playfield.size() != domConfig.getMainAreaCards().size() || stack.size() != domConfig.getBackupAreaCards().size()) {
+            std::fprintf(stderr, "LevelParseBench: streaming parse failed at %d: %s\n", (int)error.offset, error.message.c_str());
+            return 1;
+        }
+
+        BenchResult dom = runBench(iterations, [&]() {
+            LevelConfig levelConfig;
+            parseWithDocument(json, levelConfig);
+        });
+        BenchResult sax = runBench(iterations, [&]() {
+            buffer.assign(json); // In-place parsing needs a fresh copy of the text
+            LevelConfigParser::parseInsitu(&buffer[0], playfield, stack);
+        });
+
+        std::printf("%6d %8d | %12.0f %10.1f %10.0f | %12.0f %10.1f %10.0f\n",
+            cardCount, static_cast<int>(json.size()),
+            dom.medianNs, dom.allocationsPerParse, dom.bytesPerParse,
+            sax.medianNs, sax.allocationsPerParse, sax.bytesPerParse);
+    }
+    return 0;
+}
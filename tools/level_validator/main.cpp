@@ -0,0 +1,231 @@
+/**
+ * Batch level validator
+ * Solves every level_N.json in a directory on all cores and writes a
+ * CSV and/or JSON report. Runs headless: only FileUtils is used from the
+ * engine, no Director, GLView or GL context is created.
+ *
+ * Usage:
+ *   LevelValidator <levels-dir> [--csv <file>] [--json <file>] [--threads <n>]
+ *                  [--max-nodes <n>] [--any-solution]
+ */
+
+#include "../../Classes/configs/loaders/LevelConfigLoader.h"
+#include "../../Classes/services/LevelSolver.h"
+#include "../../Classes/utils/WorkStealingScheduler.h"
+#include "../common/LevelFiles.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+struct LevelReport
+{
+    LevelReport() : levelId(0), loaded(false), fieldCards(0), reserveCards(0), wallMs(0.0) {}
+
+    int levelId;
+    std::string fullPath;
+    bool loaded;
+    int fieldCards;
+    int reserveCards;
+    SolverResult result;
+    double wallMs;
+};
+
+struct ValidatorOptions
+{
+    ValidatorOptions() : threads(0) {}
+
+    std::string levelsDir;
+    std::string csvPath;
+    std::string jsonPath;
+    int threads;
+    SolverOptions solver;
+};
+
+void printUsage()
+{
+    std::printf("Usage: LevelValidator <levels-dir> [--csv <file>] [--json <file>] [--threads <n>]\n"
+                "                      [--max-nodes <n>] [--any-solution]\n");
+}
+
+bool parseArguments(int argc, char** argv, ValidatorOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--csv" && hasValue) {
+            options.csvPath = argv[++i];
+        }
+        else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        }
+        else if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--max-nodes" && hasValue) {
+            options.solver.maxNodes = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--any-solution") {
+            options.solver.findMinimumMoves = false;
+        }
+        else if (!arg.empty() && arg[0] != '-' && options.levelsDir.empty()) {
+            options.levelsDir = arg;
+        }
+        else {
+            return false;
+        }
+    }
+    return !options.levelsDir.empty();
+}
+
+void writeCsv(const std::string& path, const std::vector<LevelReport>& reports)
+{
+    std::ofstream out(path.c_str());
+    out << "level_id,file,status,solvable,min_moves,minimal,field_cards,reserve_cards,"
+           "nodes_expanded,transposition_hits,dead_end_prunes,wall_ms\n";
+    for (const auto& report : reports) {
+        const SolverResult& result = report.result;
+        out << report.levelId << ','
+            << report.fullPath << ','
+            << (report.loaded ? LevelSolver::getStatusName(result.status) : "load_failed") << ','
+            << (result.isSolvable() ? 1 : 0) << ','
+            << result.minMoves << ','
+            << (result.minimal ? 1 : 0) << ','
+            << report.fieldCards << ','
+            << report.reserveCards << ','
+            << result.stats.nodesExpanded << ','
+            << result.stats.transpositionHits << ','
+            << result.stats.deadEndPrunes << ','
+            << report.wallMs << '\n';
+    }
+}
+
+void writeJson(const std::string& path, const std::vector<LevelReport>& reports, double totalMs, int threads)
+{
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("threads");
+    writer.Int(threads);
+    writer.Key("total_ms");
+    writer.Double(totalMs);
+    writer.Key("levels");
+    writer.StartArray();
+    for (const auto& report : reports) {
+        const SolverResult& result = report.result;
+        writer.StartObject();
+        writer.Key("level_id");
+        writer.Int(report.levelId);
+        writer.Key("file");
+        writer.String(report.fullPath.c_str());
+        writer.Key("status");
+        writer.String(report.loaded ? LevelSolver::getStatusName(result.status) : "load_failed");
+        writer.Key("solvable");
+        writer.Bool(result.isSolvable());
+        writer.Key("min_moves");
+        writer.Int(result.minMoves);
+        writer.Key("minimal");
+        writer.Bool(result.minimal);
+        writer.Key("field_cards");
+        writer.Int(report.fieldCards);
+        writer.Key("reserve_cards");
+        writer.Int(report.reserveCards);
+        writer.Key("nodes_expanded");
+        writer.Uint64(result.stats.nodesExpanded);
+        writer.Key("transposition_hits");
+        writer.Uint64(result.stats.transpositionHits);
+        writer.Key("dead_end_prunes");
+        writer.Uint64(result.stats.deadEndPrunes);
+        writer.Key("wall_ms");
+        writer.Double(report.wallMs);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+
+    std::ofstream out(path.c_str());
+    out << buffer.GetString() << '\n';
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    ValidatorOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // FileUtils is created here, before any worker thread touches it
+    FileUtils* fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isDirectoryExist(options.levelsDir)) {
+        std::fprintf(stderr, "LevelValidator: not a directory: %s\n", options.levelsDir.c_str());
+        return 1;
+    }
+
+    std::vector<LevelFile> levels = listLevelFiles(options.levelsDir);
+    std::vector<LevelReport> reports(levels.size());
+
+    WorkStealingScheduler scheduler(options.threads);
+    std::vector<std::unique_ptr<LevelSolver>> solvers;
+    for (int i = 0; i < scheduler.getWorkerCount(); ++i) {
+        solvers.push_back(std::unique_ptr<LevelSolver>(new LevelSolver(options.solver)));
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    scheduler.run(levels.size(), [&](size_t index, int worker) {
+        auto levelStart = std::chrono::steady_clock::now();
+        LevelReport& report = reports[index];
+        report.levelId = levels[index].levelId;
+        report.fullPath = levels[index].fullPath;
+
+        LevelConfig levelConfig;
+        report.loaded = LevelConfigLoader::loadLevelConfigFromFile(report.fullPath, levelConfig);
+        if (report.loaded) {
+            report.fieldCards = static_cast<int>(levelConfig.getMainAreaCards().size());
+            report.reserveCards = static_cast<int>(levelConfig.getBackupAreaCards().size());
+            report.result = solvers[worker]->solveLevel(levelConfig);
+        }
+        report.wallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - levelStart).count();
+    });
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    int solvable = 0;
+    int unsolvable = 0;
+    int unfinished = 0;
+    for (const auto& report : reports) {
+        if (report.result.isSolvable()) {
+            solvable++;
+        }
+        else if (report.loaded && report.result.status == SolverStatus::UNSOLVABLE) {
+            unsolvable++;
+        }
+        else {
+            unfinished++;
+        }
+    }
+
+    if (!options.csvPath.empty()) {
+        writeCsv(options.csvPath, reports);
+    }
+    if (!options.jsonPath.empty()) {
+        writeJson(options.jsonPath, reports, totalMs, scheduler.getWorkerCount());
+    }
+
+    std::printf("LevelValidator: %d levels, %d solvable, %d unsolvable, %d failed or over budget\n",
+        static_cast<int>(reports.size()), solvable, unsolvable, unfinished);
+    std::printf("LevelValidator: %.1f ms on %d threads (%.1f levels/s, %d steals)\n",
+        totalMs, scheduler.getWorkerCount(), totalMs > 0.0 ? reports.size() * 1000.0 / totalMs : 0.0,
+        static_cast<int>(scheduler.getStealCount()));
+
+    return (unsolvable == 0 && unfinished == 0) ? 0 : 1;
+}
@@ -0,0 +1,368 @@
+/**
+ * Replay verifier
+ * Re-simulates recorded game sessions headlessly and checks each one
+ * against its final state hash, on all cores. With --synthesize it first
+ * plays random sessions on the levels of a directory, to measure
+ * throughput without real reports. With --controller every replay is also
+ * played back through a GameController on a headless view, and then the
+ * controller's own recording of it is played back again; both must end in
+ * the recorded hash, and the game it ends in must survive the trip to a
+ * CompactGameState and back. Only FileUtils is used from the engine.
+ *
+ * Usage:
+ *   ReplayVerifier <levels-dir> [replay files...] [--threads <n>]
+ *                  [--synthesize <count>] [--moves <n>] [--write <dir>] [--controller]
+ */
+
+#include "../../Classes/configs/loaders/LevelConfigLoader.h"
+#include "../../Classes/controllers/GameController.h"
+#include "../../Classes/models/CompactGameState.h"
+#include "../../Classes/services/ReplaySimulator.h"
+#include "../../Classes/views/HeadlessGameView.h"
+#include "../../Classes/utils/WorkStealingScheduler.h"
+#include "../common/LevelFiles.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+USING_NS_CC;
+
+namespace {
+
+struct VerifierOptions
+{
+    VerifierOptions() : threads(0), synthesizeCount(0), movesPerSession(200), checkController(false) {}
+
+    std::string levelsDir;
+    std::vector<std::string> replayPaths;
+    std::string writeDir;
+    int threads;
+    int synthesizeCount;
+    int movesPerSession;
+    bool checkController;
+};
+
+struct ReplayJob
+{
+    std::string name;
+    ReplayModel replay;
+    ReplayResult result;
+};
+
+void printUsage()
+{
+    std::printf("Usage: ReplayVerifier <levels-dir> [replay files...] [--threads <n>]\n"
+                "                      [--synthesize <count>] [--moves <n>] [--write <dir>] [--controller]\n");
+}
+
+bool parseArguments(int argc, char** argv, VerifierOptions& options)
+{
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) {
+            options.threads = std::atoi(argv[++i]);
+        }
+        else if (arg == "--synthesize" && hasValue) {
+            options.synthesizeCount = std::atoi(argv[++i]);
+        }
+        else if (arg == "--moves" && hasValue) {
+            options.movesPerSession = std::atoi(argv[++i]);
+        }
+        else if (arg == "--write" && hasValue) {
+            options.writeDir = argv[++i];
+        }
+        else if (arg == "--controller") {
+            options.checkController = true;
+        }
+        else if (!arg.empty() && arg[0] != '-') {
+            if (options.levelsDir.empty()) {
+                options.levelsDir = arg;
+            }
+            else {
+                options.replayPaths.push_back(arg);
+            }
+        }
+        else {
+            return false;
+        }
+    }
+    return !options.levelsDir.empty() && (options.synthesizeCount > 0 || !options.replayPaths.empty());
+}
+
+std::string getLevelPath(const std::string& levelsDir, int levelId)
+{
+    return levelsDir + "/level_" + std::to_string(levelId) + ".json";
+}
+
+// Keep a simulator on the replay's level, loading it only when it changes
+bool prepareSimulator(ReplaySimulator& simulator, const std::string& levelsDir, int levelId)
+{
+    if (simulator.isLoaded() && simulator.getLevelId() == levelId) {
+        return true;
+    }
+    LevelConfig levelConfig;
+    return LevelConfigLoader::loadLevelConfigFromFile(getLevelPath(levelsDir, levelId), levelConfig) &&
+        simulator.load(levelId, levelConfig);
+}
+
+// A random session: mostly legal matches and draws, with some undos and redos
+void synthesizeReplay(ReplaySimulator& simulator, int moves, std::mt19937& random, ReplayModel& replay)
+{
+    replay.reset(simulator.getLevelId(), 0);
+    simulator.rewind();
+
+    const ReplayCardIndex& cardIndex = simulator.getCardIndex();
+    std::vector<int> matchable;
+    for (int i = 0; i < moves; ++i) {
+        const GameModel* gameModel = simulator.getGameModel();
+        if (gameModel->getFieldCards().empty()) {
+            break;
+        }
+
+        matchable.clear();
+        CardModel* activeCard = gameModel->getActiveCard();
+        for (auto card : gameModel->getFieldCards()) {
+            if (activeCard && gameModel->isCardPlayable(card->getItemId()) &&
+                MoveGenerator::areFacesAdjacent(card->getFaceType(), activeCard->getFaceType())) {
+                matchable.push_back(cardIndex.getIndex(card->getItemId()));
+            }
+        }
+
+        ReplayEvent event;
+        unsigned roll = random() % 20;
+        if (roll == 0) {
+            event = ReplayEvent::make(ReplayEventType::UNDO);
+        }
+        else if (roll == 1) {
+            event = ReplayEvent::make(ReplayEventType::REDO);
+        }
+        else if (!matchable.empty() && (roll < 14 || gameModel->getReserveCards().empty())) {
+            event = ReplayEvent::make(ReplayEventType::MATCH, matchable[random() % matchable.size()]);
+        }
+        else {
+            event = ReplayEvent::make(ReplayEventType::DRAW);
+        }
+
+        if (simulator.play(event)) {
+            replay.addEvent(event);
+        }
+        else if (matchable.empty() && gameModel->getReserveCards().empty()) {
+            break; // Stuck
+        }
+    }
+    replay.setFinalHash(simulator.getStateHash());
+}
+
+/**
+ * Play a replay through GameController, then play the controller's own
+ * recording of it once more
+ * @return Empty if both playbacks end in the recorded hash, else what went wrong
+ */
+// Same card data and same place in the layout
+bool sameCard(const GameModel& gameModel, const GameModel& copy, const CardModel* card)
+{
+    const CardModel* copyCard = copy.getCardById(card->getItemId());
+    const OcclusionGraph& graph = gameModel.getOcclusionGraph();
+    const OcclusionGraph& copyGraph = copy.getOcclusionGraph();
+    int cardId = card->getItemId();
+    return copyCard && copyCard->getFaceType() == card->getFaceType() &&
+        copyCard->getSuitType() == card->getSuitType() && copyCard->isReversed() == card->isReversed() &&
+        copyCard->getLocation() == card->getLocation() && copyGraph.getLayer(cardId) == graph.getLayer(cardId) &&
+        copyGraph.isOnField(cardId) == graph.isOnField(cardId) &&
+        copyGraph.getCoverCount(cardId) == graph.getCoverCount(cardId);
+}
+
+// Convert a game to a compact state and back; the copy must hold the same cards in the same places
+std::string checkRoundTrip(const GameModel& gameModel)
+{
+    CompactCardTable table;
+    CompactGameState state;
+    if (!CompactGameState::fromGameModel(gameModel, table, state)) {
+        return "game does not convert to a compact state";
+    }
+    std::unique_ptr<GameModel> copy(CompactGameState::toGameModel(table, state));
+
+    const std::vector<CardModel*>& fieldCards = gameModel.getFieldCards();
+    const std::vector<CardModel*>& reserveCards = gameModel.getReserveCards();
+    const std::vector<CardModel*>& copyReserve = copy->getReserveCards();
+    bool same = copy->getFieldCards().size() == fieldCards.size() && copyReserve.size() == reserveCards.size() &&
+        (copy->getActiveCard() ? copy->getActiveCard()->getItemId() : -1) ==
+        (gameModel.getActiveCard() ? gameModel.getActiveCard()->getItemId() : -1);
+    for (size_t i = 0; same && i < reserveCards.size(); ++i) {
+        same = copyReserve[i]->getItemId() == reserveCards[i]->getItemId() &&
+            sameCard(gameModel, *copy, reserveCards[i]);
+    }
+    for (size_t i = 0; same && i < fieldCards.size(); ++i) {
+        same = sameCard(gameModel, *copy, fieldCards[i]);
+    }
+    if (same && gameModel.getActiveCard()) {
+        same = sameCard(gameModel, *copy, gameModel.getActiveCard());
+    }
+    return same ? std::string() : "game changes on the way to a compact state and back";
+}
+
+std::string checkControllerPlayback(const std::string& levelsDir, const ReplayModel& replay)
+{
+    std::shared_ptr<LevelConfig> levelConfig = std::make_shared<LevelConfig>();
+    if (!LevelConfigLoader::loadLevelConfigFromFile(getLevelPath(levelsDir, replay.getLevelId()), *levelConfig)) {
+        return "level does not load";
+    }
+
+    HeadlessGameView view;
+    GameController controller(&view);
+    if (!controller.beginGame(replay.getLevelId(), levelConfig, replay.getSeed()) || !controller.playReplay(replay, 1.0f)) {
+        return "does not start";
+    }
+    if (controller.getReplay().getFinalHash() != replay.getFinalHash()) {
+        return "playback ends in another state";
+    }
+    std::string roundTripError = checkRoundTrip(*controller.getGameModel());
+    if (!roundTripError.empty()) {
+        return roundTripError;
+    }
+    if (!controller.playReplay(controller.getReplay(), 1.0f) ||
+        controller.getReplay().getFinalHash() != replay.getFinalHash()) {
+        return "playback of its own recording ends in another state";
+    }
+    return std::string();
+}
+
+bool readReplay(const std::string& path, ReplayModel& replay)
+{
+    Data data = FileUtils::getInstance()->getDataFromFile(path);
+    return !data.isNull() && replay.deserialize(data.getBytes(), static_cast<size_t>(data.getSize()));
+}
+
+bool writeReplay(const std::string& path, const ReplayModel& replay)
+{
+    std::vector<uint8_t> bytes;
+    replay.serialize(bytes);
+    Data data;
+    data.copy(bytes.data(), static_cast<ssize_t>(bytes.size()));
+    return FileUtils::getInstance()->writeDataToFile(data, path);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    VerifierOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage();
+        return 2;
+    }
+
+    // FileUtils is created here, before any worker thread touches it
+    FileUtils* fileUtils = FileUtils::getInstance();
+    if (!fileUtils->isDirectoryExist(options.levelsDir)) {
+        std::fprintf(stderr, "ReplayVerifier: not a directory: %s\n", options.levelsDir.c_str());
+        return 1;
+    }
+
+    std::vector<ReplayJob> jobs;
+    for (const auto& path : options.replayPaths) {
+        ReplayJob job;
+        job.name = path;
+        if (!readReplay(path, job.replay)) {
+            std::fprintf(stderr, "ReplayVerifier: not a replay file: %s\n", path.c_str());
+            return 1;
+        }
+        jobs.push_back(job);
+    }
+
+    if (options.synthesizeCount > 0) {
+        std::vector<LevelFile> levels = listLevelFiles(options.levelsDir);
+        if (levels.empty()) {
+            std::fprintf(stderr, "ReplayVerifier: no levels in %s\n", options.levelsDir.c_str());
+            return 1;
+        }
+        ReplaySimulator simulator;
+        std::mt19937 random(1);
+        for (int i = 0; i < options.synthesizeCount; ++i) {
+            int levelId = levels[i * levels.size() / options.synthesizeCount].levelId;
+            if (!prepareSimulator(simulator, options.levelsDir, levelId)) {
+                std::fprintf(stderr, "ReplayVerifier: cannot load level %d\n", levelId);
+                return 1;
+            }
+            ReplayJob job;
+            job.name = "synthetic_" + std::to_string(i) + "_level_" + std::to_string(levelId);
+            synthesizeReplay(simulator, options.movesPerSession, random, job.replay);
+            if (!options.writeDir.empty()) {
+                writeReplay(options.writeDir + "/" + job.name + ".replay", job.replay);
+            }
+            jobs.push_back(job);
+        }
+    }
+
+    // Replays of one level next to each other, so simulators rarely reload
+    std::stable_sort(jobs.begin(), jobs.end(), [](const ReplayJob& a, const ReplayJob& b) {
+        return a.replay.getLevelId() < b.replay.getLevelId();
+    });
+
+    WorkStealingScheduler scheduler(options.threads);
+    std::vector<ReplaySimulator> simulators(scheduler.getWorkerCount());
+
+    uint64_t totalEvents = 0;
+    for (const auto& job : jobs) {
+        totalEvents += job.replay.getEvents().size();
+    }
+
+    auto startTime = std::chrono::steady_clock::now();
+    scheduler.run(jobs.size(), [&](size_t index, int worker) {
+        ReplayJob& job = jobs[index];
+        ReplaySimulator& simulator = simulators[worker];
+        if (!prepareSimulator(simulator, options.levelsDir, job.replay.getLevelId())) {
+            job.result.status = ReplayStatus::WRONG_LEVEL;
+            return;
+        }
+        job.result = simulator.run(job.replay);
+    });
+    double totalMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+    int verified = 0;
+    for (const auto& job : jobs) {
+        if (job.result.isVerified()) {
+            verified++;
+        }
+        else {
+            std::printf("%s: %s after %u of %u events (hash %016llx, recorded %016llx)\n", job.name.c_str(),
+                ReplaySimulator::getStatusName(job.result.status), job.result.eventsPlayed,
+                static_cast<unsigned>(job.replay.getEvents().size()),
+                static_cast<unsigned long long>(job.result.finalHash),
+                static_cast<unsigned long long>(job.replay.getFinalHash()));
+        }
+    }
+
+    // GameController runs on this thread only
+    int controllerFailed = 0;
+    if (options.checkController) {
+        for (const auto& job : jobs) {
+            if (!job.result.isVerified()) {
+                continue;
+            }
+            std::string error = checkControllerPlayback(options.levelsDir, job.replay);
+            if (!error.empty()) {
+                std::printf("%s: controller %s\n", job.name.c_str(), error.c_str());
+                controllerFailed++;
+            }
+        }
+    }
+
+    std::printf("ReplayVerifier: %d replays, %d verified, %d failed\n",
+        static_cast<int>(jobs.size()), verified, static_cast<int>(jobs.size()) - verified);
+    if (options.checkController) {
+        std::printf("ReplayVerifier: %d controller playbacks failed\n", controllerFailed);
+    }
+    std::printf("ReplayVerifier: %.1f ms on %d threads (%.0f replays/s, %.1f M events/s)\n",
+        totalMs, scheduler.getWorkerCount(), totalMs > 0.0 ? jobs.size() * 1000.0 / totalMs : 0.0,
+        totalMs > 0.0 ? totalEvents / totalMs / 1000.0 : 0.0);
+
+    return (verified == static_cast<int>(jobs.size()) && controllerFailed == 0) ? 0 : 1;
+}